@@ -26,188 +26,639 @@
 #include "strbo_url.hh"
 #include "strbo_url_helpers.hh"
 
-#include <limits>
+#include <algorithm>
+#include <cstdio>
 
-const std::string StrBoUrl::Location::valid_characters =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789$-_.~+!*'(),;/?:@=&%";
+#if defined(__SSE2__) && !defined(STRBO_URL_DISABLE_SIMD)
+#include <emmintrin.h>
+#define STRBO_URL_USE_SSE2 1
+#else /* !__SSE2__ */
+#define STRBO_URL_USE_SSE2 0
+#endif /* __SSE2__ */
 
-const std::string StrBoUrl::Location::safe_characters =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789$-_.~";
+static constexpr auto valid_characters_table =
+    StrBoUrl::Encoding::make_character_table(StrBoUrl::Location::valid_characters);
 
-void StrBoUrl::for_each_url_encoded(const std::string &src,
-                                    const std::function<void(const char *, size_t)> &apply)
+static constexpr auto structural_characters_table =
+    StrBoUrl::Encoding::make_character_table(":/%");
+
+static size_t safe_prefix_length_scalar(const char *src, size_t len)
 {
-    for(const char &ch : src)
-    {
-        if(StrBoUrl::Location::safe_characters.find(ch) != std::string::npos)
-            apply(&ch, 1);
-        else
-        {
-            char buffer[4];
-            const int len = snprintf(buffer, sizeof(buffer), "%%%02X", ch);
+    size_t i = 0;
 
-            apply(buffer, len);
-        }
-    }
+    while(i < len && StrBoUrl::Encoding::safe_characters_table[static_cast<uint8_t>(src[i])])
+        ++i;
+
+    return i;
 }
 
-static bool decode(const char ch1, const char ch2, uint8_t &out)
+static inline char *encode_byte_scalar(uint8_t ch, char *out)
 {
-    if(ch1 >= '0' && ch1 <= '9')
-        out = static_cast<uint8_t>(ch1 - '0') << 4;
-    else if(ch1 >= 'A' && ch1 <= 'F')
-        out = static_cast<uint8_t>(ch1 - 'A' + 10) << 4;
+    if(StrBoUrl::Encoding::safe_characters_table[ch])
+        *out++ = ch;
     else
-        return false;
+    {
+        *out++ = '%';
+        *out++ = StrBoUrl::Encoding::hex_digits[ch >> 4];
+        *out++ = StrBoUrl::Encoding::hex_digits[ch & 0x0f];
+    }
 
-    if(ch2 >= '0' && ch2 <= '9')
-        out |= static_cast<uint8_t>(ch2 - '0');
-    else if(ch2 >= 'A' && ch2 <= 'F')
-        out |= static_cast<uint8_t>(ch2 - 'A' + 10);
-    else
-        return false;
+    return out;
+}
+
+static size_t unsafe_count_scalar(const char *src, size_t len)
+{
+    size_t count = 0;
 
-    return true;
+    for(size_t i = 0; i < len; ++i)
+        if(!StrBoUrl::Encoding::safe_characters_table[static_cast<uint8_t>(src[i])])
+            ++count;
+
+    return count;
 }
 
-void StrBoUrl::for_each_url_decoded(const std::string &src,
-                                    const std::function<void(char)> &apply,
-                                    const std::function<void(std::string &&error)> &on_decode_error)
+#if STRBO_URL_USE_SSE2
+/*
+ * Classify 16 bytes at a time, returning a bit mask of bytes which need
+ * encoding. Bytes above 0x7F are negative in the signed comparisons below and
+ * therefore never classified as safe.
+ */
+static inline unsigned int unsafe_mask_sse2(const char *src)
 {
-    for(size_t i = 0; i < src.length(); ++i)
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i before_a = _mm_set1_epi8('a' - 1);
+    const __m128i after_z = _mm_set1_epi8('z' + 1);
+    const __m128i before_0 = _mm_set1_epi8('0' - 1);
+    const __m128i after_9 = _mm_set1_epi8('9' + 1);
+    const __m128i dollar = _mm_set1_epi8('$');
+    const __m128i minus = _mm_set1_epi8('-');
+    const __m128i underscore = _mm_set1_epi8('_');
+    const __m128i dot = _mm_set1_epi8('.');
+    const __m128i tilde = _mm_set1_epi8('~');
+
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    const __m128i lower = _mm_or_si128(v, case_bit);
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                                        _mm_cmplt_epi8(lower, after_z));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, before_0),
+                                        _mm_cmplt_epi8(v, after_9));
+    const __m128i other =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, dollar),
+                                  _mm_cmpeq_epi8(v, minus)),
+                     _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, underscore),
+                                               _mm_cmpeq_epi8(v, dot)),
+                                  _mm_cmpeq_epi8(v, tilde)));
+
+    return ~_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), other)) & 0xffffU;
+}
+
+static size_t safe_prefix_length_sse2(const char *src, size_t len)
+{
+    size_t i = 0;
+
+    for(; i + 16 <= len; i += 16)
     {
-        const char ch = src[i];
+        const unsigned int unsafe = unsafe_mask_sse2(src + i);
 
-        if(ch != '%')
-        {
-            apply(ch);
-            continue;
-        }
+        if(unsafe != 0)
+            return i + __builtin_ctz(unsafe);
+    }
 
-        if(i + 3 <= src.length())
-        {
-            uint8_t out;
+    return i + safe_prefix_length_scalar(src + i, len - i);
+}
 
-            if(decode(src[i + 1], src[i + 2], out))
-            {
-                i += 2;
-                apply(out);
-                continue;
-            }
+static size_t unsafe_count_sse2(const char *src, size_t len)
+{
+    size_t i = 0;
+    size_t count = 0;
 
-            if(on_decode_error != nullptr)
-            {
-                std::string error("Invalid URL-encoding \"");
-                error += src[i + 0];
-                error += src[i + 1];
-                error += src[i + 2];
-                error += "\" in URL \"";
-                error += src;
-                error += '"';
-                on_decode_error(std::move(error));
-            }
+    for(; i + 16 <= len; i += 16)
+        count += __builtin_popcount(unsafe_mask_sse2(src + i));
+
+    return count + unsafe_count_scalar(src + i, len - i);
+}
+#endif /* STRBO_URL_USE_SSE2 */
+
+size_t StrBoUrl::Encoding::safe_prefix_length(const char *src, size_t len)
+{
+#if STRBO_URL_USE_SSE2
+    return safe_prefix_length_sse2(src, len);
+#else /* !STRBO_URL_USE_SSE2 */
+    return safe_prefix_length_scalar(src, len);
+#endif /* STRBO_URL_USE_SSE2 */
+}
+
+size_t StrBoUrl::Encoding::encoded_length(const char *src, size_t len)
+{
+#if STRBO_URL_USE_SSE2
+    return len + 2 * unsafe_count_sse2(src, len);
+#else /* !STRBO_URL_USE_SSE2 */
+    return len + 2 * unsafe_count_scalar(src, len);
+#endif /* STRBO_URL_USE_SSE2 */
+}
+
+char *StrBoUrl::Encoding::encode_into(const char *src, size_t len, char *out)
+{
+    size_t i = 0;
+
+#if STRBO_URL_USE_SSE2
+    /* a block of safe characters is encoded as is, so copying all 16 bytes
+     * never writes past the end of the exactly sized output buffer */
+    for(; i + 16 <= len; i += 16)
+    {
+        if(unsafe_mask_sse2(src + i) == 0)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+            out += 16;
         }
-        else if(on_decode_error != nullptr)
+        else
         {
-            std::string error("URL too short for last code: \"");
-            error += src;
-            error += '"';
-            on_decode_error(std::move(error));
+            for(size_t j = i; j < i + 16; ++j)
+                out = encode_byte_scalar(src[j], out);
         }
+    }
+#endif /* STRBO_URL_USE_SSE2 */
 
-        break;
+    for(; i < len; ++i)
+        out = encode_byte_scalar(src[i], out);
+
+    return out;
+}
+
+void StrBoUrl::for_each_url_encoded(std::string_view src,
+                                    const std::function<void(const char *, size_t)> &apply)
+{
+    for_each_url_encoded(src,
+                         [&apply] (const char *enc, size_t len) { apply(enc, len); });
+}
+
+const char *StrBoUrl::ParseResult::get_message(Code code) noexcept
+{
+    switch(code)
+    {
+      case Code::OK:
+        return "No error";
+
+      case Code::WRONG_SCHEME:
+        return "Wrong scheme";
+
+      case Code::INVALID_CHARACTERS:
+        return "Invalid characters in URL";
+
+      case Code::NO_COLON:
+        return "No ':' found";
+
+      case Code::NO_SLASH:
+        return "No '/' found";
+
+      case Code::COMPONENT_EMPTY:
+        return "Component empty";
+
+      case Code::TRAILING_JUNK:
+        return "Component with trailing junk";
+
+      case Code::OUT_OF_RANGE:
+        return "Component out of range";
+
+      case Code::INVALID_ENCODING:
+        return "Invalid URL-encoding";
+
+      case Code::TRUNCATED_ENCODING:
+        return "URL too short for last code";
+
+      case Code::COMPONENT_IS_PATH:
+        return "Component is a path";
+
+      case Code::BAD_DEVICE_OR_PARTITION:
+        return "Failed parsing device and partition";
+
+      case Code::EMPTY_TRACE:
+        return "Empty trace";
+
+      case Code::EMPTY_TRACE_FIELD:
+        return "Empty field in trace";
+
+      case Code::ODD_TRACE_FIELDS:
+        return "Odd number of fields in trace";
     }
+
+    return "Unknown error";
 }
 
-std::string::size_type
-StrBoUrl::Parse::extract_field(const std::string &url, size_t offset,
-                               const char separator, FieldPolicy policy,
-                               const std::function<void(const char *error_message)> &on_error)
+const char *StrBoUrl::ParseResult::get_component_name(Component component) noexcept
+{
+    switch(component)
+    {
+      case Component::URL:
+        return "URL";
+
+      case Component::DEVICE:
+        return "Device";
+
+      case Component::PARTITION:
+        return "Partition";
+
+      case Component::REFERENCE_POINT:
+        return "Reference point";
+
+      case Component::REFERENCE_POINT_URL:
+        return "Reference point URL";
+
+      case Component::REFERENCE_ITEM_URL:
+        return "Reference item URL";
+
+      case Component::ITEM:
+        return "Item";
+
+      case Component::ITEM_NAME:
+        return "Item name";
+
+      case Component::ITEM_COMPONENT:
+        return "Item component";
+
+      case Component::ITEM_POSITION:
+        return "Item position";
+
+      case Component::TRACE:
+        return "Trace";
+
+      case Component::TRACE_ITEM_URL:
+        return "Trace item URL";
+
+      case Component::TRACE_ITEM_POSITION:
+        return "Trace item position";
+    }
+
+    return "Unknown component";
+}
+
+size_t StrBoUrl::ParseResult::format(char *buffer, size_t size,
+                                     const char *prefix) const noexcept
+{
+    if(prefix == nullptr)
+        prefix = "";
+
+    const int len = failed()
+        ? std::snprintf(buffer, size, "%s%s [%s] at offset %" PRIu32,
+                        prefix, get_message(), get_component_name(), offset_)
+        : std::snprintf(buffer, size, "%s%s", prefix,
+                        warning_ != nullptr ? warning_ : get_message());
+
+    return len > 0 ? size_t(len) : 0;
+}
+
+StrBoUrl::ParseResult
+StrBoUrl::Parse::begin_parse(std::string_view url, const Schema::StrBoLocator &scheme,
+                             StructuralIndex &index, size_t &offset) noexcept
+{
+    if(!scheme.url_matches_scheme(url))
+        return ParseResult(ParseResult::Code::WRONG_SCHEME,
+                           ParseResult::Component::URL, 0);
+
+    /* positions in URLs are stored in 32 bits */
+    if(url.length() > UINT32_MAX)
+        return ParseResult(ParseResult::Code::OUT_OF_RANGE,
+                           ParseResult::Component::URL, 0);
+
+    offset = scheme.get_scheme_name().length() + 3;
+
+    const size_t invalid_pos = index.scan(url, offset);
+
+    if(invalid_pos != StructuralIndex::npos)
+        return ParseResult(ParseResult::Code::INVALID_CHARACTERS,
+                           ParseResult::Component::URL, invalid_pos);
+
+    return ParseResult();
+}
+
+StrBoUrl::ParseResult StrBoUrl::Location::try_set_url(std::string_view url) noexcept
 {
-    const auto end_of_field = url.find(separator, offset);
+    Parse::StructuralIndex index;
+    size_t offset;
+    const auto result = Parse::begin_parse(url, *scheme_, index, offset);
+
+    if(result.failed())
+        return result;
 
-    if(end_of_field == std::string::npos)
+    invalidate_str();
+
+    return try_set_url_impl(url, offset, index);
+}
+
+size_t StrBoUrl::Location::write_to(char *buffer, size_t size) const
+{
+    if(is_str_valid())
     {
-        switch(policy)
-        {
-          case FieldPolicy::FIELD_OPTIONAL:
-            break;
+        const auto str(get_str_view());
+
+        if(!str.empty() && str.length() <= size)
+            std::copy(str.begin(), str.end(), buffer);
+
+        return str.length();
+    }
+
+    const size_t length = encoded_length();
+
+    if(length > 0 && length <= size)
+        write_impl(buffer);
+
+    return length;
+}
 
-          case FieldPolicy::MAY_BE_EMPTY:
-          case FieldPolicy::MUST_NOT_BE_EMPTY:
+void StrBoUrl::Location::str_into(std::string &dest) const
+{
+    if(is_str_valid())
+    {
+        dest = get_str_view();
+        return;
+    }
+
+    const size_t length = encoded_length();
+
+    dest.resize(length);
+
+    if(length > 0)
+        write_impl(&dest[0]);
+}
+
+size_t StrBoUrl::Location::hash() const
+{
+    if(is_str_valid())
+        return hash_url(get_str_view());
+
+    Fnv1aHash h;
+
+    if(is_valid())
+    {
+        Serialize::ChunkSink sink(
+            [] (void *context, const char *src, size_t len)
             {
-                std::string temp("No '");
-                temp += separator;
-                temp += "' found";
-                on_error(temp.c_str());
-            }
+                static_cast<Fnv1aHash *>(context)->update(src, len);
+            },
+            &h);
+        serialize_impl(sink);
+    }
 
-            break;
-        }
+    return h.get();
+}
+
+size_t StrBoUrl::Location::hash_ignoring_positions() const
+{
+    Fnv1aHash h;
+
+    if(is_valid())
+    {
+        Serialize::ChunkSink sink(
+            [] (void *context, const char *src, size_t len)
+            {
+                static_cast<Fnv1aHash *>(context)->update(src, len);
+            },
+            &h, true);
+        serialize_impl(sink);
     }
-    else
+
+    return h.get();
+}
+
+namespace
+{
+
+/* compares chunks with an expected string as they are passed */
+class Matcher
+{
+  private:
+    std::string_view expected_;
+    bool is_matching_;
+
+  public:
+    explicit Matcher(std::string_view expected):
+        expected_(expected),
+        is_matching_(true)
+    {}
+
+    void consume(const char *src, size_t len)
     {
-        switch(policy)
+        if(!is_matching_)
+            return;
+
+        if(len > expected_.length() || expected_.compare(0, len, src, len) != 0)
+            is_matching_ = false;
+        else
+            expected_.remove_prefix(len);
+    }
+
+    bool matches() const { return is_matching_ && expected_.empty(); }
+};
+
+}
+
+bool StrBoUrl::Location::equals_url(std::string_view url) const
+{
+    if(is_str_valid())
+        return get_str_view() == url;
+
+    if(!is_valid())
+        return url.empty();
+
+    Matcher m(url);
+    Serialize::ChunkSink sink(
+        [] (void *context, const char *src, size_t len)
         {
-          case FieldPolicy::FIELD_OPTIONAL:
-          case FieldPolicy::MAY_BE_EMPTY:
-            break;
+            static_cast<Matcher *>(context)->consume(src, len);
+        },
+        &m);
+    serialize_impl(sink);
 
-          case FieldPolicy::MUST_NOT_BE_EMPTY:
-            if(end_of_field <= offset)
-            {
-                on_error("Component empty");
-                return std::string::npos;
-            }
+    return m.matches();
+}
 
-            break;
-        }
+std::mutex StrBoUrl::Location::str_lock_;
+
+#ifdef __cpp_exceptions
+const char *StrBoUrl::Location::set_url(std::string_view url)
+{
+    const auto result = try_set_url(url);
+
+    switch(result.get_code())
+    {
+      case ParseResult::Code::OK:
+        return result.get_warning();
+
+      case ParseResult::Code::WRONG_SCHEME:
+        throw WrongSchemeError();
+
+      case ParseResult::Code::INVALID_CHARACTERS:
+        throw InvalidCharactersError(get_error_prefix_for_exception(), result);
+
+      default:
+        break;
     }
 
-    return end_of_field;
+    throw ParsingError(get_error_prefix_for_exception(), result);
+}
+#endif /* __cpp_exceptions */
+
+void StrBoUrl::for_each_url_decoded(std::string_view src,
+                                    const std::function<void(char)> &apply,
+                                    const std::function<void(ParseResult::Code, const char *where)> &on_decode_error)
+{
+    for_each_url_decoded(src,
+        [&apply] (char ch) { apply(ch); },
+        [&on_decode_error] (ParseResult::Code code, const char *where)
+        {
+            if(on_decode_error != nullptr)
+                on_decode_error(code, where);
+        });
 }
 
-static StrBoUrl::ObjectIndex
-parse_item_position(const std::string &url, size_t offset,
-                    size_t expected_end, bool expecting_zero_terminator,
-                    const std::function<void(const char *error_message)> &on_error)
+bool StrBoUrl::url_decode(const char *src, size_t len, std::string &dest,
+                          const std::function<void(ParseResult::Code, const char *where)> &on_decode_error)
 {
-    if(offset >= expected_end)
+    return url_decode(src, len, dest,
+        [&on_decode_error] (ParseResult::Code code, const char *where)
+        {
+            if(on_decode_error != nullptr)
+                on_decode_error(code, where);
+        });
+}
+
+template <typename AddFn>
+static size_t scan_scalar(const char *url, size_t begin, size_t end,
+                          const AddFn &add)
+{
+    for(size_t i = begin; i < end; ++i)
     {
-        on_error("Component empty");
-        return StrBoUrl::ObjectIndex();
+        const auto ch = static_cast<uint8_t>(url[i]);
+
+        if(!valid_characters_table[ch])
+            return i;
+
+        if(structural_characters_table[ch])
+            add(i);
     }
 
-    char *endptr = nullptr;
-    unsigned long long temp = strtoull(&url[offset], &endptr, 10);
+    return StrBoUrl::Parse::StructuralIndex::npos;
+}
+
+#if STRBO_URL_USE_SSE2
+static inline __m128i in_range(const __m128i v, char first, char last)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(first - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(last + 1)));
+}
+
+/*
+ * Validate 16 bytes at a time. The valid characters are all printable ASCII
+ * characters except for the space and a few small groups. Bytes above 0x7F
+ * are negative in the signed comparisons and therefore end up below the
+ * exclamation mark.
+ */
+template <typename AddFn>
+static size_t scan_sse2(const char *url, size_t begin, size_t end,
+                        const AddFn &add)
+{
+    const __m128i first_printable = _mm_set1_epi8('!');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i less = _mm_set1_epi8('<');
+    const __m128i greater = _mm_set1_epi8('>');
+    const __m128i backtick = _mm_set1_epi8('`');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i percent = _mm_set1_epi8('%');
+
+    size_t i = begin;
 
-    if(*endptr != '\0' && expecting_zero_terminator)
+    for(; i + 16 <= end; i += 16)
     {
-        on_error("Component with trailing junk");
-        return StrBoUrl::ObjectIndex();
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(url + i));
+        const __m128i invalid =
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmplt_epi8(v, first_printable),
+                             _mm_or_si128(_mm_cmpeq_epi8(v, del),
+                                          _mm_cmpeq_epi8(v, backtick))),
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, less), _mm_cmpeq_epi8(v, greater)),
+                    _mm_or_si128(_mm_or_si128(in_range(v, '"', '#'),
+                                              in_range(v, '[', '^')),
+                                 in_range(v, '{', '}'))));
+        const unsigned int invalid_mask = _mm_movemask_epi8(invalid);
+
+        if(invalid_mask != 0)
+            return i + __builtin_ctz(invalid_mask);
+
+        unsigned int structural_mask =
+            _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, colon),
+                                                        _mm_cmpeq_epi8(v, slash)),
+                                           _mm_cmpeq_epi8(v, percent)));
+
+        while(structural_mask != 0)
+        {
+            add(i + __builtin_ctz(structural_mask));
+            structural_mask &= structural_mask - 1;
+        }
     }
 
-    if((temp == std::numeric_limits<unsigned long long>::max() && errno == ERANGE) ||
-       temp > std::numeric_limits<uint32_t>::max())
+    return scan_scalar(url, i, end, add);
+}
+#endif /* STRBO_URL_USE_SSE2 */
+
+size_t StrBoUrl::Parse::StructuralIndex::scan(std::string_view url, size_t offset)
+{
+    url_ = url.data();
+    url_length_ = url.length();
+    count_ = 0;
+    more_positions_.clear();
+
+    const auto add = [this] (uint32_t pos) { this->add(pos); };
+
+#if STRBO_URL_USE_SSE2
+    return scan_sse2(url_, offset, url_length_, add);
+#else /* !STRBO_URL_USE_SSE2 */
+    return scan_scalar(url_, offset, url_length_, add);
+#endif /* STRBO_URL_USE_SSE2 */
+}
+
+size_t StrBoUrl::Parse::StructuralIndex::find(char ch, size_t from, size_t to) const
+{
+    if(to > url_length_)
+        to = url_length_;
+
+    for(const uint32_t *it = std::lower_bound(begin(), end(), from);
+        it != end() && *it < to; ++it)
     {
-        on_error("Component out of range");
-        return StrBoUrl::ObjectIndex();
+        if(url_[*it] == ch)
+            return *it;
     }
 
-    return StrBoUrl::ObjectIndex(temp);
+    return npos;
+}
+
+std::string::size_type
+StrBoUrl::Parse::extract_field(const StructuralIndex &index, size_t offset,
+                               const char separator, FieldPolicy policy,
+                               const std::function<void(ParseResult::Code, const char *where)> &on_error)
+{
+    return extract_field(index, offset, separator, policy,
+                         [&on_error] (ParseResult::Code code, const char *where)
+                         { on_error(code, where); });
 }
 
 StrBoUrl::ObjectIndex
-StrBoUrl::Parse::item_position(const std::string &url, size_t offset,
+StrBoUrl::Parse::item_position(std::string_view url, size_t offset,
                                size_t expected_end,
-                               const std::function<void(const char *error_message)> &on_error)
+                               const std::function<void(ParseResult::Code, const char *where)> &on_error)
 {
-    return parse_item_position(url, offset, expected_end, false, on_error);
+    return item_position(url, offset, expected_end,
+                         [&on_error] (ParseResult::Code code, const char *where)
+                         { on_error(code, where); });
 }
 
 StrBoUrl::ObjectIndex
-StrBoUrl::Parse::item_position(const std::string &url, size_t offset,
-                               const std::function<void(const char *error_message)> &on_error)
+StrBoUrl::Parse::item_position(std::string_view url, size_t offset,
+                               const std::function<void(ParseResult::Code, const char *where)> &on_error)
 {
-    return parse_item_position(url, offset, url.length(), true, on_error);
+    return item_position(url, offset, url.length(),
+                         [&on_error] (ParseResult::Code code, const char *where)
+                         { on_error(code, where); });
 }
@@ -24,12 +24,201 @@
 
 #include "strbo_url_schemes.hh"
 
+#include <string>
+#include <string_view>
 #include <cinttypes>
+#include <charconv>
 #include <exception>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace StrBoUrl
 {
 
+namespace Parse { class StructuralIndex; }
+namespace Serialize { class ChunkSink; }
+
+/*!
+ * Outcome of parsing a location URL.
+ *
+ * Errors are described by an error code, the URL component in which the
+ * error was detected, and the byte offset into the URL. Successful parsing
+ * may still come with a warning, which is always a static string.
+ */
+class ParseResult
+{
+  public:
+    enum class Code: uint8_t
+    {
+        OK,
+        WRONG_SCHEME,
+        INVALID_CHARACTERS,
+        NO_COLON,
+        NO_SLASH,
+        COMPONENT_EMPTY,
+        TRAILING_JUNK,
+        OUT_OF_RANGE,
+        INVALID_ENCODING,
+        TRUNCATED_ENCODING,
+        COMPONENT_IS_PATH,
+        BAD_DEVICE_OR_PARTITION,
+        EMPTY_TRACE,
+        EMPTY_TRACE_FIELD,
+        ODD_TRACE_FIELDS,
+    };
+
+    enum class Component: uint8_t
+    {
+        URL,
+        DEVICE,
+        PARTITION,
+        REFERENCE_POINT,
+        REFERENCE_POINT_URL,
+        REFERENCE_ITEM_URL,
+        ITEM,
+        ITEM_NAME,
+        ITEM_COMPONENT,
+        ITEM_POSITION,
+        TRACE,
+        TRACE_ITEM_URL,
+        TRACE_ITEM_POSITION,
+    };
+
+  private:
+    Code code_;
+    Component component_;
+    uint32_t offset_;
+    const char *warning_;
+
+  public:
+    constexpr explicit ParseResult(const char *warning = nullptr):
+        code_(Code::OK),
+        component_(Component::URL),
+        offset_(0),
+        warning_(warning)
+    {}
+
+    constexpr explicit ParseResult(Code code, Component component, size_t offset):
+        code_(code),
+        component_(component),
+        offset_(offset),
+        warning_(nullptr)
+    {}
+
+    bool is_ok() const { return code_ == Code::OK; }
+    bool failed() const { return code_ != Code::OK; }
+
+    Code get_code() const { return code_; }
+    Component get_component() const { return component_; }
+    uint32_t get_offset() const { return offset_; }
+    const char *get_warning() const { return warning_; }
+
+    const char *get_message() const { return get_message(code_); }
+    const char *get_component_name() const { return get_component_name(component_); }
+
+    /*!
+     * Write human-readable description of the result to \p buffer.
+     *
+     * The text consists of the optional \p prefix, the message, the
+     * component name, and the offset. Like \c snprintf(), at most \p size
+     * bytes including the terminating zero are written, and the length of
+     * the full text is returned. No memory is allocated.
+     */
+    size_t format(char *buffer, size_t size, const char *prefix = nullptr) const noexcept;
+
+    static const char *get_message(Code code) noexcept;
+    static const char *get_component_name(Component component) noexcept;
+};
+
+/*!
+ * Storage for the URL representation memoized by a location.
+ *
+ * The string object is allocated on first use by the allocator the storage
+ * was constructed with, which should be the allocator of the location. Like
+ * allocator-aware containers, copies start with the allocator returned by
+ * \c select_on_container_copy_construction(), moves take the allocator
+ * along, and assignments keep the allocator of the target. Copies do not
+ * take the memoized string along.
+ *
+ * The storage takes a single pointer for stateless allocators.
+ */
+template <typename StringT>
+class MemoizedStr:
+    private std::allocator_traits<typename StringT::allocator_type>::template rebind_alloc<StringT>
+{
+  private:
+    using Allocator =
+        typename std::allocator_traits<typename StringT::allocator_type>::template rebind_alloc<StringT>;
+    using Traits = std::allocator_traits<Allocator>;
+
+    StringT *str_;
+
+  public:
+    explicit MemoizedStr() noexcept: str_(nullptr) {}
+
+    explicit MemoizedStr(const typename StringT::allocator_type &alloc) noexcept:
+        Allocator(alloc),
+        str_(nullptr)
+    {}
+
+    MemoizedStr(const MemoizedStr &src) noexcept:
+        Allocator(Traits::select_on_container_copy_construction(src.get_allocator())),
+        str_(nullptr)
+    {}
+
+    MemoizedStr(MemoizedStr &&src) noexcept:
+        Allocator(src.get_allocator()),
+        str_(src.str_)
+    {
+        src.str_ = nullptr;
+    }
+
+    MemoizedStr &operator=(const MemoizedStr &) noexcept { return *this; }
+
+    MemoizedStr &operator=(MemoizedStr &&src)
+        noexcept(Traits::is_always_equal::value)
+    {
+        if(this == &src)
+            return *this;
+
+        if(get_allocator() == src.get_allocator())
+            std::swap(str_, src.str_);
+        else if(src.str_ != nullptr)
+            get() = *src.str_;
+
+        return *this;
+    }
+
+    ~MemoizedStr()
+    {
+        if(str_ == nullptr)
+            return;
+
+        Allocator &alloc(*this);
+        Traits::destroy(alloc, str_);
+        Traits::deallocate(alloc, str_, 1);
+    }
+
+    const Allocator &get_allocator() const noexcept { return *this; }
+
+    /*!
+     * The string, allocated and constructed empty on first use.
+     */
+    StringT &get()
+    {
+        if(str_ == nullptr)
+        {
+            Allocator &alloc(*this);
+            StringT *str = Traits::allocate(alloc, 1);
+            Traits::construct(alloc, str);
+            str_ = str;
+        }
+
+        return *str_;
+    }
+};
+
 /*!
  * Base class for Streaming Board location URLs.
  *
@@ -41,72 +230,224 @@ class Location
   public:
     class WrongSchemeError: public std::exception {};
 
+    /*!
+     * Exception thrown by #StrBoUrl::Location::set_url() on parsing errors.
+     *
+     * The exception only stores a pointer to the static, location-specific
+     * error prefix and the #StrBoUrl::ParseResult, so throwing and copying
+     * it never allocates. Text is generated on demand by
+     * #StrBoUrl::Location::ParsingError::format().
+     */
     class ParsingError: public std::exception
     {
-      public:
-        const std::string error_prefix_;
-        const std::string component_name_;
-        const std::string error_message_;
-        mutable std::string what_buffer;
+      private:
+        const char *error_prefix_;
+        ParseResult result_;
 
-        explicit ParsingError(const char *error_prefix, const char *component_name,
-                              const char *error_message):
+      public:
+        explicit ParsingError(const char *error_prefix,
+                              const ParseResult &result) noexcept:
             error_prefix_(error_prefix),
-            component_name_(component_name != nullptr ? component_name : "URL"),
-            error_message_(error_message)
+            result_(result)
         {}
 
-        const char *what() const throw() override
-        {
-            if(what_buffer.empty())
-            {
-                what_buffer = error_prefix_;
-                what_buffer += error_message_;
+        const char *get_error_prefix() const noexcept { return error_prefix_; }
+        const ParseResult &get_result() const noexcept { return result_; }
 
-                if(!component_name_.empty())
-                    what_buffer += " [" + component_name_ + ']';
-            }
-
-            return what_buffer.c_str();
+        /*!
+         * Write human-readable error description to \p buffer.
+         *
+         * See #StrBoUrl::ParseResult::format().
+         */
+        size_t format(char *buffer, size_t size) const noexcept
+        {
+            return result_.format(buffer, size, error_prefix_);
         }
+
+        /*!
+         * Return static error message (without prefix, component, offset).
+         */
+        const char *what() const noexcept override { return result_.get_message(); }
     };
 
     class InvalidCharactersError: public ParsingError
     {
       public:
-        explicit InvalidCharactersError(const char *error_prefix):
-            ParsingError(error_prefix, nullptr, "Invalid characters in URL")
+        explicit InvalidCharactersError(const char *error_prefix,
+                                        const ParseResult &result) noexcept:
+            ParsingError(error_prefix, result)
         {}
     };
 
-    static const std::string valid_characters;
-    static const std::string safe_characters;
+    static constexpr std::string_view valid_characters =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789$-_.~+!*'(),;/?:@=&%";
+    static constexpr std::string_view safe_characters =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789$-_.~";
 
   protected:
-    const Schema::StrBoLocator &scheme_;
+    /* pointer to static scheme object so that locations remain assignable */
+    const Schema::StrBoLocator *scheme_;
 
+  private:
+    /* whether or not the URL memoized by the location classes is current */
+    mutable std::atomic<bool> is_str_valid_;
+
+    /* taken while generating the memoized URL of any location */
+    static std::mutex str_lock_;
+
+  protected:
     explicit Location(const Schema::StrBoLocator &scheme):
-        scheme_(scheme)
+        scheme_(&scheme),
+        is_str_valid_(false)
     {}
 
-  public:
-    Location(const Location &) = delete;
-    Location &operator=(const Location &) = delete;
+    /* the memoized URL is not copied, copies are usually modified */
+    Location(const Location &src) noexcept:
+        scheme_(src.scheme_),
+        is_str_valid_(false)
+    {}
+
+    Location(Location &&src) noexcept:
+        scheme_(src.scheme_),
+        is_str_valid_(src.take_is_str_valid())
+    {}
+
+    Location &operator=(const Location &src) noexcept
+    {
+        scheme_ = src.scheme_;
+        invalidate_str();
+        return *this;
+    }
+
+    Location &operator=(Location &&src) noexcept
+    {
+        scheme_ = src.scheme_;
+        is_str_valid_.store(src.take_is_str_valid(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /*!
+     * Mark memoized URL as outdated.
+     *
+     * Must be called by all functions which modify the location.
+     */
+    void invalidate_str() { is_str_valid_.store(false, std::memory_order_relaxed); }
+
+    /*!
+     * Memoized URL representation, generated into \p memo if outdated.
+     *
+     * For use by the \c str() function members of the location classes.
+     */
+    template <typename StringT>
+    const StringT &get_memoized_str(MemoizedStr<StringT> &memo) const
+    {
+        if(!is_str_valid())
+        {
+            /* generating happens once per modification, so a single lock
+             * for all locations is good enough */
+            std::lock_guard<std::mutex> lock(str_lock_);
+
+            if(!is_str_valid())
+            {
+                StringT &str(memo.get());
+                const size_t length = is_valid() ? encoded_length_impl() : 0;
+
+                str.resize(length);
+
+                if(length > 0)
+                    write_impl(&str[0]);
+
+                is_str_valid_.store(true, std::memory_order_release);
+            }
+        }
+
+        return memo.get();
+    }
 
+  public:
     virtual ~Location() {}
 
     virtual void clear() = 0;
     virtual bool is_valid() const = 0;
 
-    std::string str() const
+    /*!
+     * Exact length of the URL representation, 0 for invalid locations.
+     */
+    size_t encoded_length() const
     {
-        if(is_valid())
-            return str_impl();
-        else
-            return "";
+        if(is_str_valid())
+            return get_str_view().length();
+
+        return is_valid() ? encoded_length_impl() : 0;
     }
 
-    /*
+    /*!
+     * Write URL representation to \p buffer of \p size bytes.
+     *
+     * The URL is written only if it fits into the buffer, and it is not
+     * zero-terminated. The length of the URL is returned in any case.
+     */
+    size_t write_to(char *buffer, size_t size) const;
+
+    /*!
+     * Replace contents of \p dest by the URL representation.
+     *
+     * The string is resized once, so reusing a string with sufficient
+     * capacity avoids allocations completely. The string is empty for
+     * invalid locations.
+     */
+    void str_into(std::string &dest) const;
+
+    /*!
+     * URL representation, empty for invalid locations.
+     *
+     * The URL is generated on first use and kept until the location is
+     * modified, so repeated calls on an unchanged location only return a
+     * reference. The reference is valid until the location is modified or
+     * destroyed. Concurrent calls on the same object are safe.
+     *
+     * The location classes hide this function by a \c str() which returns
+     * a reference to the memoized string, allocated with the allocator of
+     * the location. Through the base class, a view of it is returned.
+     */
+    std::string_view str() const { return get_str_view(); }
+
+    /*!
+     * Hash of the URL representation.
+     *
+     * The hash is equal to #StrBoUrl::hash_url() of the URL returned by
+     * #StrBoUrl::Location::str(), but it is computed from the components
+     * without generating the URL. Thus, locations stored in hash tables can
+     * be looked up by canonical URL without parsing the URL.
+     */
+    size_t hash() const;
+
+    /*!
+     * Hash of the URL representation with item positions left out.
+     *
+     * Locations which differ only in their position hints have the same
+     * hash. The result is unrelated to #StrBoUrl::Location::hash().
+     */
+    size_t hash_ignoring_positions() const;
+
+    /*!
+     * Compare URL representation with \p url without generating it.
+     */
+    bool equals_url(std::string_view url) const;
+
+    /*!
+     * Set URL object from raw string, reporting errors by return value.
+     *
+     * In case the URL scheme doesn't match the expected scheme, the result
+     * code is #StrBoUrl::ParseResult::Code::WRONG_SCHEME, and the object is
+     * left untouched. The object state is undefined after any other error.
+     *
+     * On success, the result may carry a static warning string.
+     */
+    ParseResult try_set_url(std::string_view url) noexcept;
+
+#ifdef __cpp_exceptions
+    /*!
      * Set URL object from raw string.
      *
      * In case the URL scheme doesn't match the expected scheme, a
@@ -117,36 +458,72 @@ class Location
      *
      * This function usually returns \c nullptr, but when it doesn't, its
      * return value points to a static warning string.
+     *
+     * This is a wrapper around #StrBoUrl::Location::try_set_url(), and it is
+     * available only if exceptions are enabled.
      */
-    const char *set_url(const std::string &url)
-    {
-        if(!scheme_.url_matches_scheme(url))
-            throw WrongSchemeError();
+    const char *set_url(std::string_view url);
+#endif /* __cpp_exceptions */
 
-        if(url.find_first_not_of(valid_characters) != std::string::npos)
-            throw InvalidCharactersError(get_error_prefix_for_exception());
+  private:
+    bool is_str_valid() const
+    {
+        return is_str_valid_.load(std::memory_order_acquire);
+    }
 
-        return set_url_impl(url, scheme_.get_scheme_name().length() + 3);
+    bool take_is_str_valid() noexcept
+    {
+        return is_str_valid_.exchange(false, std::memory_order_relaxed);
     }
 
   protected:
+    /*!
+     * Return view of the memoized URL, generating it if necessary.
+     *
+     * Implemented by the location classes by calling their \c str().
+     */
+    virtual std::string_view get_str_view() const = 0;
+
     /*!
      * Return string containing a location-specific error prefix.
      */
     virtual const char *get_error_prefix_for_exception() const = 0;
 
     /*!
-     * Return string representation of the location.
+     * Return length of the string representation of the location.
      *
-     * This function is supposed to return a URL following its configured
+     * Contract: This function is called only if a preceding call of
+     *     #StrBoUrl::Location::is_valid() returned \c true. The length must
+     *     be exactly the number of bytes written by
+     *     #StrBoUrl::Location::write_impl().
+     */
+    virtual size_t encoded_length_impl() const = 0;
+
+    /*!
+     * Write string representation of the location to \p out.
+     *
+     * This function is supposed to write a URL following its configured
      * scheme.
      *
      * Contract: This function is called only if a preceding call of
-     *     #StrBoUrl::Location::is_valid() returned \c true. Therefore, this
+     *     #StrBoUrl::Location::is_valid() returned \c true, and \p out
+     *     points to a buffer of the size returned by
+     *     #StrBoUrl::Location::encoded_length_impl(). Therefore, this
      *     function needs to perform no further checks and is required to
-     *     return a valid, non-empty URL.
+     *     write a valid, non-empty URL.
+     */
+    virtual void write_impl(char *out) const = 0;
+
+    /*!
+     * Pass string representation of the location to \p sink in chunks.
+     *
+     * Contract: This function is called only if a preceding call of
+     *     #StrBoUrl::Location::is_valid() returned \c true. The chunks must
+     *     add up to the data written by #StrBoUrl::Location::write_impl(),
+     *     except for item positions which are left out if the sink asks
+     *     for it.
      */
-    virtual std::string str_impl() const = 0;
+    virtual void serialize_impl(Serialize::ChunkSink &sink) const = 0;
 
     /*!
      * Set URL object by string.
@@ -154,8 +531,8 @@ class Location
      * This function is supposed to parse the URL and initialize the object
      * using the URL components.
      *
-     * In case of any parsing errors, this function is supposed to throw a
-     * #StrBoUrl::Location::ParsingError exception.
+     * In case of any parsing errors, this function is supposed to return a
+     * #StrBoUrl::ParseResult describing the error. It must not throw.
      *
      * It shall not simply copy the URL. The #StrBoUrl::Location::str()
      * function member shall always generate URL strings from the object state,
@@ -164,8 +541,13 @@ class Location
      * Contract: The URL scheme is guaranteed to match the configurated scheme.
      *     Implementations should not check the scheme prefix again. The offset
      *     parameter points at the first character after the scheme definition.
+     *     All characters in the URL are guaranteed to be valid, and the
+     *     positions of all structural characters after the offset are stored
+     *     in the index. Implementations should look up separators in the
+     *     index and not search the URL.
      */
-    virtual const char *set_url_impl(const std::string &url, size_t offset) = 0;
+    virtual ParseResult try_set_url_impl(std::string_view url, size_t offset,
+                                         const Parse::StructuralIndex &index) noexcept = 0;
 };
 
 /*!
@@ -184,6 +566,9 @@ class ObjectIndex
     uint32_t idx_;
 
   public:
+    /*! Maximum number of characters written by #StrBoUrl::ObjectIndex::to_chars(). */
+    static constexpr size_t MAX_CHARS = 10;
+
     constexpr explicit ObjectIndex(uint32_t idx = 0):
         idx_(idx)
     {}
@@ -191,6 +576,120 @@ class ObjectIndex
     bool is_valid() const { return idx_ > 0; }
 
     uint32_t get_object_index() const { return idx_; }
+
+    /*!
+     * Parse decimal number in range [\p begin, \p end).
+     *
+     * The whole range must consist of decimal digits. There is no dependency
+     * on the locale or \c errno, and no character outside the range is read.
+     *
+     * \returns
+     *     #StrBoUrl::ParseResult::Code::OK on success,
+     *     #StrBoUrl::ParseResult::Code::COMPONENT_EMPTY for empty ranges,
+     *     #StrBoUrl::ParseResult::Code::TRAILING_JUNK for non-digits (with
+     *     \p where pointing to the first non-digit), or
+     *     #StrBoUrl::ParseResult::Code::OUT_OF_RANGE for numbers which do
+     *     not fit. In case of error, \p idx is left untouched.
+     */
+    static ParseResult::Code from_chars(const char *begin, const char *end,
+                                        ObjectIndex &idx, const char *&where) noexcept
+    {
+        where = begin;
+
+        if(begin >= end)
+            return ParseResult::Code::COMPONENT_EMPTY;
+
+        uint32_t value;
+        const auto result = std::from_chars(begin, end, value);
+
+        if(result.ec == std::errc::result_out_of_range)
+            return ParseResult::Code::OUT_OF_RANGE;
+
+        if(result.ec != std::errc() || result.ptr != end)
+        {
+            where = result.ptr;
+            return ParseResult::Code::TRAILING_JUNK;
+        }
+
+        idx = ObjectIndex(value);
+        return ParseResult::Code::OK;
+    }
+
+    /*!
+     * Write decimal representation to [\p begin, \p end).
+     *
+     * \returns
+     *     Pointer past the last character written, or \c nullptr if the
+     *     buffer is too small. The output is not zero-terminated.
+     */
+    char *to_chars(char *begin, char *end) const noexcept
+    {
+        const auto result = std::to_chars(begin, end, idx_);
+        return result.ec == std::errc() ? result.ptr : nullptr;
+    }
+};
+
+/*!
+ * Incremental 64 bit FNV-1a hash.
+ */
+class Fnv1aHash
+{
+  private:
+    uint64_t hash_;
+
+  public:
+    constexpr explicit Fnv1aHash(): hash_(UINT64_C(14695981039346656037)) {}
+
+    void update(const char *data, size_t len)
+    {
+        for(size_t i = 0; i < len; ++i)
+        {
+            hash_ ^= uint8_t(data[i]);
+            hash_ *= UINT64_C(1099511628211);
+        }
+    }
+
+    size_t get() const { return size_t(hash_); }
+};
+
+/*!
+ * Hash of a URL, equal to #StrBoUrl::Location::hash() of the location it
+ * represents if the URL is in canonical form.
+ *
+ * URLs generated by this library are canonical. Incoming URLs may differ in
+ * the case of percent-encoded characters or in unneeded encodings, and
+ * those would need to be parsed and generated again to match.
+ */
+inline size_t hash_url(std::string_view url)
+{
+    Fnv1aHash h;
+    h.update(url.data(), url.length());
+    return h.get();
+}
+
+/*!
+ * Transparent hash function for locations and their URLs.
+ */
+struct LocationHash
+{
+    using is_transparent = void;
+
+    size_t operator()(const Location &l) const { return l.hash(); }
+    size_t operator()(std::string_view url) const { return hash_url(url); }
+};
+
+/*!
+ * Transparent equality for locations of the same type and their URLs.
+ */
+struct LocationEqual
+{
+    using is_transparent = void;
+
+    template <typename T>
+    bool operator()(const T &a, const T &b) const { return a == b; }
+
+    bool operator()(const Location &a, std::string_view b) const { return a.equals_url(b); }
+    bool operator()(std::string_view a, const Location &b) const { return b.equals_url(a); }
 };
 
 }
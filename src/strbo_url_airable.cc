@@ -26,171 +26,306 @@
 #include "strbo_url_airable.hh"
 #include "strbo_url_helpers.hh"
 
-#include <sstream>
+#include <algorithm>
 
-std::string Airable::LocationKeySimple::str_impl() const
+template <typename SinkFn, typename StringT>
+static void serialize(SinkFn &sink, const StrBoUrl::Schema::StrBoLocator &scheme,
+                      const Airable::BasicLocationKeySimple<StringT> &l)
 {
-    std::string result = scheme_.get_scheme_name() + "://";
+    const auto &c(l.unpack());
 
-    StrBoUrl::for_each_url_encoded(c_.item_url_,
-        [&result] (const char *enc, size_t len) { result.append(enc, len); });
+    StrBoUrl::Serialize::scheme(sink, scheme);
+    StrBoUrl::Serialize::encoded(sink, c.item_url_);
+}
 
-    return result;
+template <typename StringT>
+size_t Airable::BasicLocationKeySimple<StringT>::encoded_length_impl() const
+{
+    StrBoUrl::Serialize::LengthSink sink;
+    serialize(sink, *scheme_, *this);
+    return sink.get_length();
+}
+
+template <typename StringT>
+void Airable::BasicLocationKeySimple<StringT>::write_impl(char *out) const
+{
+    StrBoUrl::Serialize::BufferSink sink(out);
+    serialize(sink, *scheme_, *this);
+}
+
+template <typename StringT>
+void Airable::BasicLocationKeySimple<StringT>::serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const
+{
+    serialize(sink, *scheme_, *this);
 }
 
-const char *Airable::LocationKeySimple::get_error_prefix()
+template <typename StringT>
+const char *Airable::BasicLocationKeySimple<StringT>::get_error_prefix()
 {
     return "Simple Airable location key malformed: ";
 }
 
-const char *Airable::LocationKeySimple::set_url_impl(const std::string &url,
-                                                     size_t offset)
+StrBoUrl::ParseResult Airable::LocationKeySimpleView::try_set_url(std::string_view url) noexcept
 {
-    c_.item_url_.clear();
-    is_item_set_ = true;
+    return StrBoUrl::Parse::parse_view(*this, url, LocationKeySimple::get_scheme());
+}
 
+StrBoUrl::ParseResult
+Airable::LocationKeySimpleView::parse_fields(std::string_view url, size_t offset,
+                                             const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
     if(offset >= url.length())
-        return "Simple Airable location key is empty";
+    {
+        set_url_buffer(url);
+        item_ = StrBoUrl::FieldRef();
+        return StrBoUrl::ParseResult("Simple Airable location key is empty");
+    }
+
+    StrBoUrl::Parse::ErrorCollector errors(url.data());
 
-    StrBoUrl::for_each_url_decoded(url.substr(offset),
-        [this] (const char ch) { c_.item_url_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), nullptr, e.c_str()); } );
+    if(!StrBoUrl::Parse::check_encoding(index, offset, url.length(),
+                                        errors.in(StrBoUrl::ParseResult::Component::ITEM)))
+        return errors.get_result();
 
-    const char *result;
+    set_url_buffer(url);
+    item_ = StrBoUrl::FieldRef(offset, url.length());
 
-    if(c_.item_url_ == "/")
+    if(StrBoUrl::Parse::is_encoded_root(raw(item_)))
     {
-        result = "Simple Airable location key contains unneeded explicit reference to root";
-        c_.item_url_.clear();
+        item_ = StrBoUrl::FieldRef();
+        return StrBoUrl::ParseResult("Simple Airable location key contains unneeded explicit reference to root");
     }
-    else
-        result = nullptr;
 
-    return result;
+    return StrBoUrl::ParseResult();
 }
 
-std::string Airable::LocationKeyReference::str_impl() const
+template <typename StringT>
+void Airable::BasicLocationKeySimple<StringT>::set_from_view(const LocationKeySimpleView &view)
 {
-    std::ostringstream os;
-    os << scheme_.get_scheme_name() << "://";
+    invalidate_str();
 
-    StrBoUrl::for_each_url_encoded(c_.containing_list_url_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+    if(!view.is_valid())
+    {
+        clear();
+        return;
+    }
 
-    os << '/';
+    view.decode(view.get_item(), c_.item_url_);
+    is_item_set_ = true;
+}
 
-    StrBoUrl::for_each_url_encoded(c_.item_url_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+template <typename StringT>
+StrBoUrl::ParseResult
+Airable::BasicLocationKeySimple<StringT>::try_set_url_impl(std::string_view url, size_t offset,
+                                                           const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    LocationKeySimpleView view;
+    const auto result = view.parse_fields(url, offset, index);
+
+    if(result.is_ok())
+        set_from_view(view);
 
-    os << ':' << c_.item_position_.get_object_index();
+    return result;
+}
+
+template <typename SinkFn, typename StringT>
+static void serialize(SinkFn &sink, const StrBoUrl::Schema::StrBoLocator &scheme,
+                      const Airable::BasicLocationKeyReference<StringT> &l)
+{
+    const auto &c(l.unpack());
+
+    StrBoUrl::Serialize::scheme(sink, scheme);
+    StrBoUrl::Serialize::encoded(sink, c.containing_list_url_);
+    StrBoUrl::Serialize::character(sink, '/');
+    StrBoUrl::Serialize::encoded(sink, c.item_url_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::position(sink, c.item_position_);
+}
+
+template <typename StringT>
+size_t Airable::BasicLocationKeyReference<StringT>::encoded_length_impl() const
+{
+    StrBoUrl::Serialize::LengthSink sink;
+    serialize(sink, *scheme_, *this);
+    return sink.get_length();
+}
+
+template <typename StringT>
+void Airable::BasicLocationKeyReference<StringT>::write_impl(char *out) const
+{
+    StrBoUrl::Serialize::BufferSink sink(out);
+    serialize(sink, *scheme_, *this);
+}
 
-    return os.str();
+template <typename StringT>
+void Airable::BasicLocationKeyReference<StringT>::serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const
+{
+    serialize(sink, *scheme_, *this);
 }
 
-const char *Airable::LocationKeyReference::get_error_prefix()
+template <typename StringT>
+const char *Airable::BasicLocationKeyReference<StringT>::get_error_prefix()
 {
     return "Reference Airable location key malformed: ";
 }
 
-const char *Airable::LocationKeyReference::set_url_impl(const std::string &url,
-                                                        size_t offset)
+StrBoUrl::ParseResult Airable::LocationKeyReferenceView::try_set_url(std::string_view url) noexcept
+{
+    return StrBoUrl::Parse::parse_view(*this, url, LocationKeyReference::get_scheme());
+}
+
+StrBoUrl::ParseResult
+Airable::LocationKeyReferenceView::parse_fields(std::string_view url, size_t offset,
+                                                const StrBoUrl::Parse::StructuralIndex &index) noexcept
 {
+    using Component = StrBoUrl::ParseResult::Component;
+    StrBoUrl::Parse::ErrorCollector errors(url.data());
+
     const auto end_of_reference = StrBoUrl::Parse::extract_field(
-        url, offset, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Reference point", error_message);
-        });
+        index, offset, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
+        errors.in(Component::REFERENCE_POINT));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto end_of_item = StrBoUrl::Parse::extract_field(
-        url, end_of_reference + 1, ':',
+        index, end_of_reference + 1, ':',
         StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item", error_message);
-        });
+        errors.in(Component::ITEM));
 
-    const auto item_position = StrBoUrl::Parse::item_position(
-        url, end_of_item + 1,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item position", error_message);
-        });
+    if(errors.failed())
+        return errors.get_result();
 
-    c_.containing_list_url_.clear();
-    c_.item_url_.clear();
-    c_.item_position_ = item_position;
-    is_containing_list_set_ = true;
+    const auto item_position = StrBoUrl::Parse::item_position(
+        url, end_of_item + 1, errors.in(Component::ITEM_POSITION));
 
-    if(offset < end_of_reference)
-        StrBoUrl::for_each_url_decoded(url.substr(offset, end_of_reference - offset),
-            [this] (const char ch) { c_.containing_list_url_ += ch; },
-            [] (std::string &&e) { throw ParsingError(get_error_prefix(), nullptr, e.c_str()); } );
+    if(errors.failed())
+        return errors.get_result();
 
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_reference + 1,
-                                              end_of_item - end_of_reference - 1),
-        [this] (const char ch) { c_.item_url_ += ch; },
-        [] (std::string &&e) { throw ParsingError(get_error_prefix(), nullptr, e.c_str()); } );
+    if(!StrBoUrl::Parse::check_encoding(index, offset, end_of_reference,
+                                        errors.in(Component::REFERENCE_POINT_URL)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_reference + 1, end_of_item,
+                                        errors.in(Component::REFERENCE_ITEM_URL)))
+        return errors.get_result();
 
-    const char *result;
+    set_url_buffer(url);
+    containing_list_ = StrBoUrl::FieldRef(offset, end_of_reference);
+    item_ = StrBoUrl::FieldRef(end_of_reference + 1, end_of_item);
+    item_position_ = item_position;
 
-    if(c_.containing_list_url_ == "/")
+    if(StrBoUrl::Parse::is_encoded_root(raw(containing_list_)))
     {
-        result = "Reference Airable location key contains unneeded explicit reference to root";
+        containing_list_ = StrBoUrl::FieldRef();
+        return StrBoUrl::ParseResult("Reference Airable location key contains unneeded explicit reference to root");
+    }
 
-        c_.containing_list_url_.clear();
+    return StrBoUrl::ParseResult();
+}
+
+template <typename StringT>
+void Airable::BasicLocationKeyReference<StringT>::set_from_view(const LocationKeyReferenceView &view)
+{
+    invalidate_str();
+
+    if(!view.is_valid())
+    {
+        clear();
+        return;
     }
-    else
-        result = nullptr;
+
+    view.decode(view.get_containing_list(), c_.containing_list_url_);
+    view.decode(view.get_item(), c_.item_url_);
+    c_.item_position_ = view.get_item_position();
+    is_containing_list_set_ = true;
+}
+
+template <typename StringT>
+StrBoUrl::ParseResult
+Airable::BasicLocationKeyReference<StringT>::try_set_url_impl(std::string_view url, size_t offset,
+                                                              const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    LocationKeyReferenceView view;
+    const auto result = view.parse_fields(url, offset, index);
+
+    if(result.is_ok())
+        set_from_view(view);
 
     return result;
 }
 
-std::string Airable::LocationTrace::str_impl() const
+/*!
+ * Pass level \p i of trace including its leading separator to \p sink.
+ */
+template <typename SinkFn, typename StringT>
+static void serialize_trace_level(SinkFn &sink, const Airable::BasicTraceLevels<StringT> &levels,
+                                  size_t i)
 {
-    std::ostringstream os;
-    os << scheme_.get_scheme_name() << "://";
+    StrBoUrl::Serialize::character(sink, i == 0 ? '/' : ':');
+    StrBoUrl::Serialize::encoded(sink, levels.get_url(i));
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::position(sink, levels.get_position(i));
+}
 
-    StrBoUrl::for_each_url_encoded(c_.reference_point_url_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+template <typename SinkFn, typename StringT>
+static void serialize(SinkFn &sink, const StrBoUrl::Schema::StrBoLocator &scheme,
+                      const Airable::BasicLocationTrace<StringT> &l)
+{
+    const auto &c(l.unpack());
 
-    if(!c_.trace_urls_.empty())
-        os << '/';
+    StrBoUrl::Serialize::scheme(sink, scheme);
 
-    bool is_first = true;
+    const auto encoded_trace(l.get_encoded_trace());
 
-    for(const auto &component : c_.trace_urls_)
+    if(!encoded_trace.empty() && StrBoUrl::Serialize::wants_positions(sink))
+        sink(encoded_trace.data(), encoded_trace.length());
+    else
     {
-        if(is_first)
-            is_first = false;
-        else
-            os << ':';
-
-        StrBoUrl::for_each_url_encoded(component.first,
-            [&os] (const char *enc, size_t len) { os.write(enc, len); });
+        StrBoUrl::Serialize::encoded(sink, c.reference_point_url_);
 
-        os << ':' << component.second.get_object_index();
+        for(size_t i = 0; i < c.trace_urls_.size(); ++i)
+            serialize_trace_level(sink, c.trace_urls_, i);
     }
 
-    os << '/';
+    StrBoUrl::Serialize::character(sink, '/');
+    StrBoUrl::Serialize::encoded(sink, c.item_url_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::position(sink, c.item_position_);
+}
 
-    StrBoUrl::for_each_url_encoded(c_.item_url_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+template <typename StringT>
+size_t Airable::BasicLocationTrace<StringT>::encoded_length_impl() const
+{
+    StrBoUrl::Serialize::LengthSink sink;
+    serialize(sink, *scheme_, *this);
+    return sink.get_length();
+}
 
-    os << ':' << c_.item_position_.get_object_index();
+template <typename StringT>
+void Airable::BasicLocationTrace<StringT>::write_impl(char *out) const
+{
+    StrBoUrl::Serialize::BufferSink sink(out);
+    serialize(sink, *scheme_, *this);
+}
 
-    return os.str();
+template <typename StringT>
+void Airable::BasicLocationTrace<StringT>::serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const
+{
+    serialize(sink, *scheme_, *this);
 }
 
-static void parse_trace(const std::string &t,
+/*!
+ * Validate trace in range [\p start, \p end).
+ */
+static void check_trace(std::string_view t, const StrBoUrl::Parse::StructuralIndex &index,
                         const size_t start, const size_t end,
-                        decltype(Airable::LocationTrace::Components::trace_urls_) &trace,
-                        const std::function<void(const char *component_name, const char *error_message)> &on_error)
+                        StrBoUrl::Parse::ErrorCollector &errors)
 {
+    using Code = StrBoUrl::ParseResult::Code;
+    using Component = StrBoUrl::ParseResult::Component;
+
     if(start >= end)
     {
-        on_error(nullptr, "Empty trace");
+        errors.set(Code::EMPTY_TRACE, Component::TRACE, t.data() + start);
         return;
     }
 
@@ -199,35 +334,37 @@ static void parse_trace(const std::string &t,
 
     while(start_of_token < end)
     {
-        auto end_of_field = t.find(':', start_of_token);
+        auto end_of_field = index.find(':', start_of_token, end);
 
-        if(end_of_field == std::string::npos)
+        if(end_of_field == StrBoUrl::Parse::StructuralIndex::npos)
             end_of_field = end;
         else if(end_of_field == start_of_token)
         {
-            on_error(nullptr, "Empty field in trace");
+            errors.set(Code::EMPTY_TRACE_FIELD, Component::TRACE, t.data() + start_of_token);
             return;
         }
 
         if(expecting_item_url)
         {
-            trace.emplace_back(std::make_pair(std::string(), StrBoUrl::ObjectIndex()));
-            auto &dest(trace.back().first);
-            StrBoUrl::for_each_url_decoded(t.substr(start_of_token, end_of_field - start_of_token),
-                [&dest] (const char ch) { dest += ch; },
-                [&on_error] (std::string &&e) { on_error("Trace item URL", e.c_str()); } );
+            if(!StrBoUrl::Parse::check_encoding(index, start_of_token, end_of_field,
+                                                errors.in(Component::TRACE_ITEM_URL)))
+                return;
         }
         else
         {
-            trace.back().second = StrBoUrl::Parse::item_position(
+            const auto position = StrBoUrl::Parse::item_position(
                 t, start_of_token, end_of_field,
-                [&on_error] (const char *error_message)
-                {
-                    on_error("Trace item position", error_message);
-                });
+                errors.in(Component::TRACE_ITEM_POSITION));
+
+            if(errors.failed())
+                return;
 
-            if(!trace.back().second.is_valid())
+            if(!position.is_valid())
+            {
+                errors.set(Code::OUT_OF_RANGE, Component::TRACE_ITEM_POSITION,
+                           t.data() + start_of_token);
                 return;
+            }
         }
 
         expecting_item_url = !expecting_item_url;
@@ -235,29 +372,47 @@ static void parse_trace(const std::string &t,
     }
 
     if(!expecting_item_url)
-        on_error(nullptr, "Odd number of fields in trace");
+        errors.set(Code::ODD_TRACE_FIELDS, Component::TRACE, t.data() + start);
+}
+
+size_t Airable::LocationTraceView::get_trace_length() const
+{
+    if(trace_.empty())
+        return 0;
+
+    const auto t = raw(trace_);
+
+    return (std::count(t.begin(), t.end(), ':') + 1) / 2;
 }
 
-const char *Airable::LocationTrace::get_error_prefix()
+template <typename StringT>
+const char *Airable::BasicLocationTrace<StringT>::get_error_prefix()
 {
     return "Airable location trace malformed: ";
 }
 
-const char *Airable::LocationTrace::set_url_impl(const std::string &url, size_t offset)
+StrBoUrl::ParseResult Airable::LocationTraceView::try_set_url(std::string_view url) noexcept
 {
+    return StrBoUrl::Parse::parse_view(*this, url, LocationTrace::get_scheme());
+}
+
+StrBoUrl::ParseResult
+Airable::LocationTraceView::parse_fields(std::string_view url, size_t offset,
+                                         const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    using Component = StrBoUrl::ParseResult::Component;
+    StrBoUrl::Parse::ErrorCollector errors(url.data());
+
     const auto end_of_reference = StrBoUrl::Parse::extract_field(
-        url, offset, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Reference point", error_message);
-        });
+        index, offset, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
+        errors.in(Component::REFERENCE_POINT));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto end_of_trace = StrBoUrl::Parse::extract_field(
-        url, end_of_reference + 1, '/', StrBoUrl::Parse::FieldPolicy::FIELD_OPTIONAL,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Trace", error_message);
-        });
+        index, end_of_reference + 1, '/', StrBoUrl::Parse::FieldPolicy::FIELD_OPTIONAL,
+        errors.in(Component::TRACE));
 
     const size_t start_of_item = (end_of_trace == std::string::npos
                                   ? end_of_reference
@@ -266,52 +421,139 @@ const char *Airable::LocationTrace::set_url_impl(const std::string &url, size_t
         end_of_trace == std::string::npos || end_of_trace == end_of_reference;
 
     const auto end_of_item = StrBoUrl::Parse::extract_field(
-        url, start_of_item, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item", error_message);
-        });
+        index, start_of_item, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::ITEM));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto item_position = StrBoUrl::Parse::item_position(
-        url, end_of_item + 1,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item position", error_message);
-        });
+        url, end_of_item + 1, errors.in(Component::ITEM_POSITION));
 
-    decltype(Components::trace_urls_) trace;
+    if(errors.failed())
+        return errors.get_result();
 
     if(!is_trace_empty)
-       parse_trace(url, end_of_reference + 1, end_of_trace, trace,
-                   [] (const char *component_name, const char *error_message)
-                   {
-                       throw ParsingError(get_error_prefix(), component_name, error_message);
-                   });
-
-    c_.reference_point_url_.clear();
-    c_.trace_urls_ = std::move(trace);
-    c_.item_url_.clear();
-    c_.item_position_ = item_position;
-    is_reference_point_set_ = true;
+    {
+        check_trace(url, index, end_of_reference + 1, end_of_trace, errors);
 
-    if(offset < end_of_reference)
-        StrBoUrl::for_each_url_decoded(url.substr(offset, end_of_reference - offset),
-            [this] (const char ch) { c_.reference_point_url_ += ch; },
-            [] (std::string &&e) { throw ParsingError(get_error_prefix(), "Reference point URL", e.c_str()); } );
+        if(errors.failed())
+            return errors.get_result();
+    }
 
-    StrBoUrl::for_each_url_decoded(url.substr(start_of_item, end_of_item - start_of_item),
-        [this] (const char ch) { c_.item_url_ += ch; },
-        [] (std::string &&e) { throw ParsingError(get_error_prefix(), "Reference item URL", e.c_str()); } );
+    if(!StrBoUrl::Parse::check_encoding(index, offset, end_of_reference,
+                                        errors.in(Component::REFERENCE_POINT_URL)) ||
+       !StrBoUrl::Parse::check_encoding(index, start_of_item, end_of_item,
+                                        errors.in(Component::REFERENCE_ITEM_URL)))
+        return errors.get_result();
+
+    set_url_buffer(url);
+    reference_point_ = StrBoUrl::FieldRef(offset, end_of_reference);
+    trace_ = is_trace_empty
+        ? StrBoUrl::FieldRef()
+        : StrBoUrl::FieldRef(end_of_reference + 1, end_of_trace);
+    item_ = StrBoUrl::FieldRef(start_of_item, end_of_item);
+    item_position_ = item_position;
+
+    if(StrBoUrl::Parse::is_encoded_root(raw(reference_point_)))
+    {
+        reference_point_ = StrBoUrl::FieldRef();
+        return StrBoUrl::ParseResult("Airable location trace contains unneeded explicit reference to root");
+    }
 
-    const char *result;
+    return StrBoUrl::ParseResult();
+}
 
-    if(c_.reference_point_url_ == "/")
+template <typename StringT>
+void Airable::BasicLocationTrace<StringT>::set_from_view(const LocationTraceView &view)
+{
+    invalidate_str();
+
+    if(!view.is_valid())
     {
-        result = "Airable location trace contains unneeded explicit reference to root";
-        c_.reference_point_url_.clear();
+        clear();
+        return;
     }
-    else
-        result = nullptr;
+
+    forget_encoded_trace();
+    view.decode(view.get_reference_point(), c_.reference_point_url_);
+
+    /* decoded URLs are never longer than their encoded form, so the length
+     * of the encoded trace is enough to hold all levels */
+    c_.trace_urls_.clear();
+    c_.trace_urls_.reserve(view.get_trace_length(), view.get_trace().get_length());
+    view.for_each_trace_level(
+        [this, &view] (StrBoUrl::FieldRef url, StrBoUrl::ObjectIndex position)
+        {
+            c_.trace_urls_.push_back(view, url, position);
+        });
+
+    view.decode(view.get_item(), c_.item_url_);
+    c_.item_position_ = view.get_item_position();
+    is_reference_point_set_ = true;
+}
+
+template <typename StringT>
+void Airable::BasicLocationTrace<StringT>::push_level(std::string_view raw_url,
+                                                     StrBoUrl::ObjectIndex position)
+{
+    invalidate_str();
+
+    if(encoded_ends_.empty())
+    {
+        /* first push: encode everything we have so far */
+        auto sink([this] (const char *data, size_t len) { encoded_trace_.append(data, len); });
+
+        encoded_trace_.clear();
+        encoded_ends_.reserve(c_.trace_urls_.size() + 2);
+        StrBoUrl::Serialize::encoded(sink, c_.reference_point_url_);
+        encoded_ends_.push_back(encoded_trace_.length());
+
+        for(size_t i = 0; i < c_.trace_urls_.size(); ++i)
+        {
+            serialize_trace_level(sink, c_.trace_urls_, i);
+            encoded_ends_.push_back(encoded_trace_.length());
+        }
+    }
+
+    c_.trace_urls_.push_back(raw_url, position);
+    encode_last_level();
+}
+
+template <typename StringT>
+void Airable::BasicLocationTrace<StringT>::encode_last_level()
+{
+    auto sink([this] (const char *data, size_t len) { encoded_trace_.append(data, len); });
+
+    serialize_trace_level(sink, c_.trace_urls_, c_.trace_urls_.size() - 1);
+    encoded_ends_.push_back(encoded_trace_.length());
+}
+
+template <typename StringT>
+StrBoUrl::ParseResult
+Airable::BasicLocationTrace<StringT>::try_set_url_impl(std::string_view url, size_t offset,
+                                                       const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    LocationTraceView view;
+    const auto result = view.parse_fields(url, offset, index);
+
+    if(result.is_ok())
+        set_from_view(view);
 
     return result;
 }
+
+template class Airable::BasicLocationKeySimple<std::string>;
+template class Airable::BasicLocationKeySimple<std::pmr::string>;
+template class Airable::BasicLocationKeyReference<std::string>;
+template class Airable::BasicLocationKeyReference<std::pmr::string>;
+template class Airable::BasicLocationTrace<std::string>;
+template class Airable::BasicLocationTrace<std::pmr::string>;
+
+/* std::vector moves locations on reallocation only if these hold */
+static_assert(std::is_nothrow_move_constructible_v<Airable::BasicLocationKeySimple<std::string>>);
+static_assert(std::is_nothrow_move_constructible_v<Airable::BasicLocationKeySimple<std::pmr::string>>);
+static_assert(std::is_nothrow_move_constructible_v<Airable::BasicLocationKeyReference<std::string>>);
+static_assert(std::is_nothrow_move_constructible_v<Airable::BasicLocationKeyReference<std::pmr::string>>);
+static_assert(std::is_nothrow_move_constructible_v<Airable::BasicLocationTrace<std::string>>);
+static_assert(std::is_nothrow_move_constructible_v<Airable::BasicLocationTrace<std::pmr::string>>);
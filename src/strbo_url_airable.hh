@@ -22,9 +22,11 @@
 #ifndef STRBO_URL_AIRABLE_HH
 #define STRBO_URL_AIRABLE_HH
 
-#include "strbo_url.hh"
+#include "strbo_url_view.hh"
 
+#include <memory_resource>
 #include <vector>
+#include <algorithm>
 
 namespace Airable
 {
@@ -35,7 +37,7 @@ namespace Airable
 class ResourceLocatorHTTPS: public ::StrBoUrl::Schema::ResourceLocatorSimple
 {
   public:
-    explicit ResourceLocatorHTTPS():
+    constexpr explicit ResourceLocatorHTTPS():
         StrBoUrl::Schema::ResourceLocatorSimple("https")
     {}
 };
@@ -46,7 +48,7 @@ class ResourceLocatorHTTPS: public ::StrBoUrl::Schema::ResourceLocatorSimple
 class ResourceLocatorHTTP: public ::StrBoUrl::Schema::ResourceLocatorSimple
 {
   public:
-    explicit ResourceLocatorHTTP():
+    constexpr explicit ResourceLocatorHTTP():
         StrBoUrl::Schema::ResourceLocatorSimple("http")
     {}
 };
@@ -57,7 +59,7 @@ class ResourceLocatorHTTP: public ::StrBoUrl::Schema::ResourceLocatorSimple
 class ResourceLocatorSimple: public ::StrBoUrl::Schema::ResourceLocatorSimple
 {
   public:
-    explicit ResourceLocatorSimple():
+    constexpr explicit ResourceLocatorSimple():
         StrBoUrl::Schema::ResourceLocatorSimple("strbo-airable")
     {}
 };
@@ -68,7 +70,7 @@ class ResourceLocatorSimple: public ::StrBoUrl::Schema::ResourceLocatorSimple
 class ResourceLocatorReference: public ::StrBoUrl::Schema::ResourceLocatorReference
 {
   public:
-    explicit ResourceLocatorReference():
+    constexpr explicit ResourceLocatorReference():
         StrBoUrl::Schema::ResourceLocatorReference("strbo-ref-airable")
     {}
 };
@@ -79,43 +81,97 @@ class ResourceLocatorReference: public ::StrBoUrl::Schema::ResourceLocatorRefere
 class TraceLocator: public ::StrBoUrl::Schema::TraceLocator
 {
   public:
-    explicit TraceLocator():
+    constexpr explicit TraceLocator():
         StrBoUrl::Schema::TraceLocator("strbo-trace-airable")
     {}
 };
 
+/*!
+ * Non-owning view of an Airable simple location key.
+ */
+class LocationKeySimpleView: public ::StrBoUrl::LocationView
+{
+  private:
+    StrBoUrl::FieldRef item_;
+
+  public:
+    explicit LocationKeySimpleView() {}
+
+    void clear() { *this = LocationKeySimpleView(); }
+
+    /*!
+     * Set view from URL in caller-owned buffer.
+     *
+     * See #StrBoUrl::Location::try_set_url().
+     */
+    StrBoUrl::ParseResult try_set_url(std::string_view url) noexcept;
+
+    StrBoUrl::FieldRef get_item() const { return item_; }
+
+    StrBoUrl::ParseResult
+    parse_fields(std::string_view url, size_t offset,
+                 const StrBoUrl::Parse::StructuralIndex &index) noexcept;
+};
+
 /*!
  * Representation of an Airable simple location key.
  */
-class LocationKeySimple: public ::StrBoUrl::Location
+template <typename StringT>
+class BasicLocationKeySimple: public ::StrBoUrl::Location
 {
   public:
+    using allocator_type = typename StringT::allocator_type;
+
     struct Components
     {
-        std::string item_url_;
+        StringT item_url_;
 
         Components() {}
 
-        explicit Components(std::string &&item_url):
+        explicit Components(const allocator_type &alloc):
+            item_url_(alloc)
+        {}
+
+        explicit Components(StringT &&item_url):
             item_url_(std::move(item_url))
         {}
     };
 
   private:
     Components c_;
+    mutable ::StrBoUrl::MemoizedStr<StringT> str_memo_;
     bool is_item_set_;
 
   public:
-    LocationKeySimple(const LocationKeySimple &) = delete;
-    LocationKeySimple &operator=(const LocationKeySimple &) = delete;
+    BasicLocationKeySimple(const BasicLocationKeySimple &) = default;
+    BasicLocationKeySimple(BasicLocationKeySimple &&) = default;
+    BasicLocationKeySimple &operator=(const BasicLocationKeySimple &) = default;
+    BasicLocationKeySimple &operator=(BasicLocationKeySimple &&) = default;
+
+    explicit BasicLocationKeySimple():
+        ::StrBoUrl::Location(get_scheme()),
+        is_item_set_(false)
+    {}
 
-    explicit LocationKeySimple():
+    /*!
+     * Construct empty location whose components use \p alloc.
+     */
+    explicit BasicLocationKeySimple(const allocator_type &alloc):
         ::StrBoUrl::Location(get_scheme()),
+        c_(alloc),
+        str_memo_(alloc),
         is_item_set_(false)
     {}
 
+    explicit BasicLocationKeySimple(const LocationKeySimpleView &view):
+        BasicLocationKeySimple()
+    {
+        set_from_view(view);
+    }
+
     void clear() final override
     {
+        invalidate_str();
         c_.item_url_.clear();
         is_item_set_ = false;
     }
@@ -124,22 +180,54 @@ class LocationKeySimple: public ::StrBoUrl::Location
 
     void set_item(const char *raw_url)
     {
+        invalidate_str();
         c_.item_url_ = raw_url;
         is_item_set_ = true;
     }
 
-    void set_item(std::string &&url)
+    void set_item(StringT &&url)
     {
+        invalidate_str();
         c_.item_url_ = std::move(url);
         is_item_set_ = true;
     }
 
+    /*!
+     * Set object from decoded components of a view.
+     */
+    void set_from_view(const LocationKeySimpleView &view);
+
     const Components &unpack() const { return c_; }
 
+    /*!
+     * Compare components.
+     */
+    friend bool operator==(const BasicLocationKeySimple &a, const BasicLocationKeySimple &b)
+    {
+        return a.is_item_set_ == b.is_item_set_ && a.c_.item_url_ == b.c_.item_url_;
+    }
+
+    friend bool operator!=(const BasicLocationKeySimple &a, const BasicLocationKeySimple &b) { return !(a == b); }
+
+    /*!
+     * Same as comparison by \c operator==(), there are no item positions.
+     */
+    bool equals_ignoring_positions(const BasicLocationKeySimple &other) const { return *this == other; }
+
+    /*!
+     * URL representation, memoized with the allocator of the location.
+     */
+    const StringT &str() const { return get_memoized_str(str_memo_); }
+
   protected:
+    std::string_view get_str_view() const final override { return str(); }
     const char *get_error_prefix_for_exception() const final override { return get_error_prefix(); }
-    std::string str_impl() const final override;
-    const char *set_url_impl(const std::string &url, size_t offset) final override;
+    size_t encoded_length_impl() const final override;
+    void write_impl(char *out) const final override;
+    void serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const final override;
+    StrBoUrl::ParseResult
+    try_set_url_impl(std::string_view url, size_t offset,
+                     const StrBoUrl::Parse::StructuralIndex &index) noexcept final override;
 
   private:
     static const char *get_error_prefix();
@@ -147,27 +235,77 @@ class LocationKeySimple: public ::StrBoUrl::Location
   public:
     static const ::StrBoUrl::Schema::StrBoLocator &get_scheme()
     {
-        static const ::Airable::ResourceLocatorSimple scheme;
+        static constexpr ::Airable::ResourceLocatorSimple scheme;
         return scheme;
     }
 };
 
+using LocationKeySimple = BasicLocationKeySimple<std::string>;
+
+namespace pmr
+{
+/*!
+ * Variant of #Airable::LocationKeySimple which allocates its components from a
+ * \c std::pmr::memory_resource passed to the constructor.
+ */
+using LocationKeySimple = BasicLocationKeySimple<std::pmr::string>;
+}
+
+/*!
+ * Non-owning view of an Airable reference location key.
+ */
+class LocationKeyReferenceView: public ::StrBoUrl::LocationView
+{
+  private:
+    StrBoUrl::FieldRef containing_list_;
+    StrBoUrl::FieldRef item_;
+    StrBoUrl::ObjectIndex item_position_;
+
+  public:
+    explicit LocationKeyReferenceView() {}
+
+    void clear() { *this = LocationKeyReferenceView(); }
+
+    /*!
+     * Set view from URL in caller-owned buffer.
+     *
+     * See #StrBoUrl::Location::try_set_url().
+     */
+    StrBoUrl::ParseResult try_set_url(std::string_view url) noexcept;
+
+    StrBoUrl::FieldRef get_containing_list() const { return containing_list_; }
+    StrBoUrl::FieldRef get_item() const { return item_; }
+    StrBoUrl::ObjectIndex get_item_position() const { return item_position_; }
+
+    StrBoUrl::ParseResult
+    parse_fields(std::string_view url, size_t offset,
+                 const StrBoUrl::Parse::StructuralIndex &index) noexcept;
+};
+
 /*!
  * Representation of an Airable reference location key.
  */
-class LocationKeyReference: public ::StrBoUrl::Location
+template <typename StringT>
+class BasicLocationKeyReference: public ::StrBoUrl::Location
 {
   public:
+    using allocator_type = typename StringT::allocator_type;
+
     struct Components
     {
-        std::string containing_list_url_;
-        std::string item_url_;
+        StringT containing_list_url_;
+        StringT item_url_;
         StrBoUrl::ObjectIndex item_position_;
 
         Components() {}
 
-        explicit Components(std::string &&containing_list_url,
-                            std::string &&item_url,
+        explicit Components(const allocator_type &alloc):
+            containing_list_url_(alloc),
+            item_url_(alloc)
+        {}
+
+        explicit Components(StringT &&containing_list_url,
+                            StringT &&item_url,
                             StrBoUrl::ObjectIndex item_position):
             containing_list_url_(std::move(containing_list_url)),
             item_url_(std::move(item_url)),
@@ -177,19 +315,39 @@ class LocationKeyReference: public ::StrBoUrl::Location
 
   private:
     Components c_;
+    mutable ::StrBoUrl::MemoizedStr<StringT> str_memo_;
     bool is_containing_list_set_;
 
   public:
-    LocationKeyReference(const LocationKeyReference &) = delete;
-    LocationKeyReference &operator=(const LocationKeyReference &) = delete;
+    BasicLocationKeyReference(const BasicLocationKeyReference &) = default;
+    BasicLocationKeyReference(BasicLocationKeyReference &&) = default;
+    BasicLocationKeyReference &operator=(const BasicLocationKeyReference &) = default;
+    BasicLocationKeyReference &operator=(BasicLocationKeyReference &&) = default;
 
-    explicit LocationKeyReference():
+    explicit BasicLocationKeyReference():
         ::StrBoUrl::Location(get_scheme()),
         is_containing_list_set_(false)
     {}
 
+    /*!
+     * Construct empty location whose components use \p alloc.
+     */
+    explicit BasicLocationKeyReference(const allocator_type &alloc):
+        ::StrBoUrl::Location(get_scheme()),
+        c_(alloc),
+        str_memo_(alloc),
+        is_containing_list_set_(false)
+    {}
+
+    explicit BasicLocationKeyReference(const LocationKeyReferenceView &view):
+        BasicLocationKeyReference()
+    {
+        set_from_view(view);
+    }
+
     void clear() final override
     {
+        invalidate_str();
         c_.containing_list_url_.clear();
         c_.item_url_.clear();
         c_.item_position_ = StrBoUrl::ObjectIndex();
@@ -203,34 +361,79 @@ class LocationKeyReference: public ::StrBoUrl::Location
 
     void set_containing_list(const char *raw_url)
     {
+        invalidate_str();
         c_.containing_list_url_ = raw_url;
         is_containing_list_set_ = true;
     }
 
-    void set_containing_list(std::string &&url)
+    void set_containing_list(StringT &&url)
     {
+        invalidate_str();
         c_.containing_list_url_ = std::move(url);
         is_containing_list_set_ = true;
     }
 
     void set_item(const char *raw_url, StrBoUrl::ObjectIndex position)
     {
+        invalidate_str();
         c_.item_url_ = raw_url;
         c_.item_position_ = position;
     }
 
-    void set_item(std::string &&url, StrBoUrl::ObjectIndex position)
+    void set_item(StringT &&url, StrBoUrl::ObjectIndex position)
     {
+        invalidate_str();
         c_.item_url_ = std::move(url);
         c_.item_position_ = position;
     }
 
+    /*!
+     * Set object from decoded components of a view.
+     */
+    void set_from_view(const LocationKeyReferenceView &view);
+
     const Components &unpack() const { return c_; }
 
+    /*!
+     * Compare components, including item positions.
+     */
+    friend bool operator==(const BasicLocationKeyReference &a, const BasicLocationKeyReference &b) { return a.equals(b, true); }
+    friend bool operator!=(const BasicLocationKeyReference &a, const BasicLocationKeyReference &b) { return !a.equals(b, true); }
+
+    /*!
+     * Compare components except for item positions.
+     *
+     * Locations which are equal in this sense refer to the same item.
+     */
+    bool equals_ignoring_positions(const BasicLocationKeyReference &other) const
+    {
+        return equals(other, false);
+    }
+
+    /*!
+     * URL representation, memoized with the allocator of the location.
+     */
+    const StringT &str() const { return get_memoized_str(str_memo_); }
+
+  private:
+    bool equals(const BasicLocationKeyReference &other, bool compare_positions) const
+    {
+        return is_containing_list_set_ == other.is_containing_list_set_ &&
+               c_.containing_list_url_ == other.c_.containing_list_url_ &&
+               c_.item_url_ == other.c_.item_url_ &&
+               (!compare_positions ||
+                c_.item_position_.get_object_index() == other.c_.item_position_.get_object_index());
+    }
+
   protected:
+    std::string_view get_str_view() const final override { return str(); }
     const char *get_error_prefix_for_exception() const final override { return get_error_prefix(); }
-    std::string str_impl() const final override;
-    const char *set_url_impl(const std::string &url, size_t offset) final override;
+    size_t encoded_length_impl() const final override;
+    void write_impl(char *out) const final override;
+    void serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const final override;
+    StrBoUrl::ParseResult
+    try_set_url_impl(std::string_view url, size_t offset,
+                     const StrBoUrl::Parse::StructuralIndex &index) noexcept final override;
 
   private:
     static const char *get_error_prefix();
@@ -238,29 +441,218 @@ class LocationKeyReference: public ::StrBoUrl::Location
   public:
     static const ::StrBoUrl::Schema::StrBoLocator &get_scheme()
     {
-        static const ::Airable::ResourceLocatorReference scheme;
+        static constexpr ::Airable::ResourceLocatorReference scheme;
         return scheme;
     }
 };
 
+using LocationKeyReference = BasicLocationKeyReference<std::string>;
+
+namespace pmr
+{
+/*!
+ * Variant of #Airable::LocationKeyReference which allocates its components from a
+ * \c std::pmr::memory_resource passed to the constructor.
+ */
+using LocationKeyReference = BasicLocationKeyReference<std::pmr::string>;
+}
+
+/*!
+ * Non-owning view of an Airable location trace.
+ */
+class LocationTraceView: public ::StrBoUrl::LocationView
+{
+  private:
+    StrBoUrl::FieldRef reference_point_;
+    StrBoUrl::FieldRef trace_;
+    StrBoUrl::FieldRef item_;
+    StrBoUrl::ObjectIndex item_position_;
+
+  public:
+    explicit LocationTraceView() {}
+
+    void clear() { *this = LocationTraceView(); }
+
+    /*!
+     * Set view from URL in caller-owned buffer.
+     *
+     * See #StrBoUrl::Location::try_set_url().
+     */
+    StrBoUrl::ParseResult try_set_url(std::string_view url) noexcept;
+
+    StrBoUrl::FieldRef get_reference_point() const { return reference_point_; }
+    StrBoUrl::FieldRef get_trace() const { return trace_; }
+    StrBoUrl::FieldRef get_item() const { return item_; }
+    StrBoUrl::ObjectIndex get_item_position() const { return item_position_; }
+
+    size_t get_trace_length() const;
+
+    /*!
+     * Call \p apply for each level in the trace.
+     *
+     * The callback may be any callable taking a #StrBoUrl::FieldRef for the
+     * encoded URL and a #StrBoUrl::ObjectIndex.
+     */
+    template <typename ApplyFn>
+    void for_each_trace_level(ApplyFn &&apply) const
+    {
+        const auto t = get_url();
+        const size_t end = trace_.get_offset() + trace_.get_length();
+        size_t pos = trace_.get_offset();
+
+        while(pos < end)
+        {
+            const size_t end_of_url = std::min(t.find(':', pos), end);
+            const size_t end_of_position = std::min(t.find(':', end_of_url + 1), end);
+
+            apply(StrBoUrl::FieldRef(pos, end_of_url),
+                  StrBoUrl::Parse::item_position(t, end_of_url + 1, end_of_position,
+                                                 [] (StrBoUrl::ParseResult::Code, const char *) {}));
+
+            pos = end_of_position + 1;
+        }
+    }
+
+    StrBoUrl::ParseResult
+    parse_fields(std::string_view url, size_t offset,
+                 const StrBoUrl::Parse::StructuralIndex &index) noexcept;
+};
+
+/*!
+ * Levels of an Airable location trace.
+ *
+ * The decoded URLs of all levels are stored back to back in a single string,
+ * accompanied by an array holding the end offset and item position for each
+ * level. Thus, there are only two allocations regardless of the number of
+ * levels, and each level is accessible in constant time.
+ */
+template <typename StringT>
+class BasicTraceLevels
+{
+  public:
+    using allocator_type = typename StringT::allocator_type;
+
+  private:
+    struct Level
+    {
+        uint32_t end_;
+        StrBoUrl::ObjectIndex position_;
+    };
+
+    using Levels =
+        std::vector<Level, typename std::allocator_traits<allocator_type>::template
+                               rebind_alloc<Level>>;
+
+    StringT urls_;
+    Levels levels_;
+
+  public:
+    BasicTraceLevels() {}
+
+    explicit BasicTraceLevels(const allocator_type &alloc):
+        urls_(alloc),
+        levels_(alloc)
+    {}
+
+    allocator_type get_allocator() const { return urls_.get_allocator(); }
+
+    size_t size() const { return levels_.size(); }
+    bool empty() const { return levels_.empty(); }
+
+    void clear()
+    {
+        urls_.clear();
+        levels_.clear();
+    }
+
+    /*!
+     * Reserve space for \p levels levels with \p bytes URL bytes in total.
+     */
+    void reserve(size_t levels, size_t bytes)
+    {
+        levels_.reserve(levels);
+        urls_.reserve(bytes);
+    }
+
+    std::string_view get_url(size_t i) const
+    {
+        const uint32_t begin = i > 0 ? levels_[i - 1].end_ : 0;
+        return std::string_view(urls_.data() + begin, levels_[i].end_ - begin);
+    }
+
+    StrBoUrl::ObjectIndex get_position(size_t i) const { return levels_[i].position_; }
+
+    bool equals(const BasicTraceLevels &other, bool compare_positions) const
+    {
+        if(urls_ != other.urls_ || levels_.size() != other.levels_.size())
+            return false;
+
+        for(size_t i = 0; i < levels_.size(); ++i)
+            if(levels_[i].end_ != other.levels_[i].end_ ||
+               (compare_positions &&
+                levels_[i].position_.get_object_index() !=
+                other.levels_[i].position_.get_object_index()))
+                return false;
+
+        return true;
+    }
+
+    std::pair<std::string_view, StrBoUrl::ObjectIndex> operator[](size_t i) const
+    {
+        return std::make_pair(get_url(i), get_position(i));
+    }
+
+    void push_back(std::string_view url, StrBoUrl::ObjectIndex position)
+    {
+        urls_.append(url.data(), url.length());
+        levels_.push_back(Level{uint32_t(urls_.length()), position});
+    }
+
+    void pop_back()
+    {
+        levels_.pop_back();
+        urls_.resize(levels_.empty() ? 0 : levels_.back().end_);
+    }
+
+    /*!
+     * Append level by URL-decoding \p url from \p view.
+     */
+    void push_back(const StrBoUrl::LocationView &view, StrBoUrl::FieldRef url,
+                   StrBoUrl::ObjectIndex position)
+    {
+        view.decode(url, [this] (const char *data, size_t len) { urls_.append(data, len); });
+        levels_.push_back(Level{uint32_t(urls_.length()), position});
+    }
+};
+
 /*!
  * Representation of an Airable location trace.
  */
-class LocationTrace: public ::StrBoUrl::Location
+template <typename StringT>
+class BasicLocationTrace: public ::StrBoUrl::Location
 {
   public:
+    using allocator_type = typename StringT::allocator_type;
+    using TraceURLs = BasicTraceLevels<StringT>;
+
     struct Components
     {
-        std::string reference_point_url_;
-        std::vector<std::pair<std::string, StrBoUrl::ObjectIndex>> trace_urls_;
-        std::string item_url_;
+        StringT reference_point_url_;
+        TraceURLs trace_urls_;
+        StringT item_url_;
         StrBoUrl::ObjectIndex item_position_;
 
         Components() {}
 
-        explicit Components(std::string &&reference_point_url,
-                            std::vector<std::pair<std::string, StrBoUrl::ObjectIndex>> &&trace_urls,
-                            std::string &&item_url, StrBoUrl::ObjectIndex item_position):
+        explicit Components(const allocator_type &alloc):
+            reference_point_url_(alloc),
+            trace_urls_(alloc),
+            item_url_(alloc)
+        {}
+
+        explicit Components(StringT &&reference_point_url,
+                            TraceURLs &&trace_urls,
+                            StringT &&item_url, StrBoUrl::ObjectIndex item_position):
             reference_point_url_(std::move(reference_point_url)),
             trace_urls_(std::move(trace_urls)),
             item_url_(std::move(item_url)),
@@ -269,25 +661,63 @@ class LocationTrace: public ::StrBoUrl::Location
     };
 
   private:
+    using EncodedEnds =
+        std::vector<uint32_t, typename std::allocator_traits<allocator_type>::template
+                                  rebind_alloc<uint32_t>>;
+
     Components c_;
+    mutable ::StrBoUrl::MemoizedStr<StringT> str_memo_;
     bool is_reference_point_set_;
 
+    /*!
+     * URL-encoded reference point and trace, maintained by #push_level().
+     *
+     * Element \c k of \c encoded_ends_ is the length of the encoded
+     * reference point followed by the first \c k trace levels. Both are
+     * empty unless #push_level() has been used since the reference point
+     * or the whole trace was last set.
+     */
+    StringT encoded_trace_;
+    EncodedEnds encoded_ends_;
+
   public:
-    LocationTrace(const LocationTrace &) = delete;
-    LocationTrace &operator=(const LocationTrace &) = delete;
+    BasicLocationTrace(const BasicLocationTrace &) = default;
+    BasicLocationTrace(BasicLocationTrace &&) = default;
+    BasicLocationTrace &operator=(const BasicLocationTrace &) = default;
+    BasicLocationTrace &operator=(BasicLocationTrace &&) = default;
 
-    explicit LocationTrace():
+    explicit BasicLocationTrace():
         ::StrBoUrl::Location(get_scheme()),
         is_reference_point_set_(false)
     {}
 
+    /*!
+     * Construct empty location whose components use \p alloc.
+     */
+    explicit BasicLocationTrace(const allocator_type &alloc):
+        ::StrBoUrl::Location(get_scheme()),
+        c_(alloc),
+        str_memo_(alloc),
+        is_reference_point_set_(false),
+        encoded_trace_(alloc),
+        encoded_ends_(alloc)
+    {}
+
+    explicit BasicLocationTrace(const LocationTraceView &view):
+        BasicLocationTrace()
+    {
+        set_from_view(view);
+    }
+
     void clear() final override
     {
+        invalidate_str();
         c_.reference_point_url_.clear();
         c_.trace_urls_.clear();
         c_.item_url_.clear();
         c_.item_position_ = StrBoUrl::ObjectIndex();
         is_reference_point_set_ = false;
+        forget_encoded_trace();
     }
 
     bool is_valid() const final override
@@ -295,60 +725,210 @@ class LocationTrace: public ::StrBoUrl::Location
         return is_reference_point_set_ && !c_.item_url_.empty() && c_.item_position_.is_valid();
     }
 
-    size_t get_trace_length() const;
+    size_t get_trace_length() const { return c_.trace_urls_.size(); }
+
+    std::string_view get_trace_url(size_t level) const { return c_.trace_urls_.get_url(level); }
+
+    StrBoUrl::ObjectIndex get_trace_position(size_t level) const
+    {
+        return c_.trace_urls_.get_position(level);
+    }
 
     void set_reference_point(const char *raw_url)
     {
+        invalidate_str();
         c_.reference_point_url_ = raw_url;
         is_reference_point_set_ = true;
+        forget_encoded_trace();
     }
 
-    void set_reference_point(std::string &&url)
+    void set_reference_point(StringT &&url)
     {
+        invalidate_str();
         c_.reference_point_url_ = std::move(url);
         is_reference_point_set_ = true;
+        forget_encoded_trace();
     }
 
     void append_to_trace(const char *raw_url, StrBoUrl::ObjectIndex position)
     {
-        c_.trace_urls_.emplace_back(std::make_pair(std::string(raw_url), position));
+        invalidate_str();
+        c_.trace_urls_.push_back(raw_url, position);
+
+        if(!encoded_ends_.empty())
+            encode_last_level();
     }
 
-    void append_to_trace(std::string &&raw_url, StrBoUrl::ObjectIndex position)
+    void append_to_trace(StringT &&raw_url, StrBoUrl::ObjectIndex position)
     {
-        c_.trace_urls_.emplace_back(std::make_pair(std::move(raw_url), position));
+        invalidate_str();
+        c_.trace_urls_.push_back(raw_url, position);
+
+        if(!encoded_ends_.empty())
+            encode_last_level();
+    }
+
+    /*!
+     * Enter list \p raw_url at \p position as innermost trace level.
+     *
+     * Unlike #append_to_trace(), the URL-encoded reference point and trace
+     * are kept along with the trace, so that serialization copies them
+     * instead of encoding all levels again. The first push encodes the
+     * levels present so far; afterwards, each push encodes only its new
+     * level.
+     */
+    void push_level(std::string_view raw_url, StrBoUrl::ObjectIndex position);
+
+    /*!
+     * Remove innermost trace level in constant time.
+     *
+     * \returns
+     *     False if the trace is empty.
+     */
+    bool pop_level()
+    {
+        invalidate_str();
+        if(c_.trace_urls_.empty())
+            return false;
+
+        c_.trace_urls_.pop_back();
+
+        if(!encoded_ends_.empty())
+        {
+            encoded_ends_.pop_back();
+            encoded_trace_.resize(encoded_ends_.back());
+        }
+
+        return true;
+    }
+
+    /*!
+     * URL-encoded reference point and trace kept by #push_level(), or
+     * empty string if there is none.
+     */
+    std::string_view get_encoded_trace() const
+    {
+        return encoded_ends_.empty()
+            ? std::string_view()
+            : std::string_view(encoded_trace_.data(), encoded_trace_.length());
     }
 
     void set_item(const char *raw_url, StrBoUrl::ObjectIndex position)
     {
+        invalidate_str();
         c_.item_url_ = raw_url;
         c_.item_position_ = position;
     }
 
-    void set_item(std::string &&url, StrBoUrl::ObjectIndex position)
+    void set_item(StringT &&url, StrBoUrl::ObjectIndex position)
     {
+        invalidate_str();
         c_.item_url_ = std::move(url);
         c_.item_position_ = position;
     }
 
+    /*!
+     * Set object from decoded components of a view.
+     */
+    void set_from_view(const LocationTraceView &view);
+
     const Components &unpack() const { return c_; }
 
+    /*!
+     * Compare components, including item positions.
+     */
+    friend bool operator==(const BasicLocationTrace &a, const BasicLocationTrace &b) { return a.equals(b, true); }
+    friend bool operator!=(const BasicLocationTrace &a, const BasicLocationTrace &b) { return !a.equals(b, true); }
+
+    /*!
+     * Compare components except for item positions.
+     *
+     * Locations which are equal in this sense refer to the same item.
+     */
+    bool equals_ignoring_positions(const BasicLocationTrace &other) const
+    {
+        return equals(other, false);
+    }
+
+    /*!
+     * URL representation, memoized with the allocator of the location.
+     */
+    const StringT &str() const { return get_memoized_str(str_memo_); }
+
+  private:
+    bool equals(const BasicLocationTrace &other, bool compare_positions) const
+    {
+        return is_reference_point_set_ == other.is_reference_point_set_ &&
+               c_.reference_point_url_ == other.c_.reference_point_url_ &&
+               c_.trace_urls_.equals(other.c_.trace_urls_, compare_positions) &&
+               c_.item_url_ == other.c_.item_url_ &&
+               (!compare_positions ||
+                c_.item_position_.get_object_index() == other.c_.item_position_.get_object_index());
+    }
+
   protected:
+    std::string_view get_str_view() const final override { return str(); }
     const char *get_error_prefix_for_exception() const final override { return get_error_prefix(); }
-    std::string str_impl() const final override;
-    const char *set_url_impl(const std::string &url, size_t offset) final override;
+    size_t encoded_length_impl() const final override;
+    void write_impl(char *out) const final override;
+    void serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const final override;
+    StrBoUrl::ParseResult
+    try_set_url_impl(std::string_view url, size_t offset,
+                     const StrBoUrl::Parse::StructuralIndex &index) noexcept final override;
 
   private:
     static const char *get_error_prefix();
 
+    void encode_last_level();
+
+    void forget_encoded_trace()
+    {
+        encoded_trace_.clear();
+        encoded_ends_.clear();
+    }
+
   public:
     static const ::StrBoUrl::Schema::StrBoLocator &get_scheme()
     {
-        static const ::Airable::TraceLocator scheme;
+        static constexpr ::Airable::TraceLocator scheme;
         return scheme;
     }
 };
 
+using LocationTrace = BasicLocationTrace<std::string>;
+
+namespace pmr
+{
+/*!
+ * Variant of #Airable::LocationTrace which allocates its components from a
+ * \c std::pmr::memory_resource passed to the constructor.
+ */
+using LocationTrace = BasicLocationTrace<std::pmr::string>;
+}
+
+}
+
+namespace std
+{
+
+template <typename StringT>
+struct hash<Airable::BasicLocationKeySimple<StringT>>
+{
+    size_t operator()(const Airable::BasicLocationKeySimple<StringT> &l) const { return l.hash(); }
+};
+
+template <typename StringT>
+struct hash<Airable::BasicLocationKeyReference<StringT>>
+{
+    size_t operator()(const Airable::BasicLocationKeyReference<StringT> &l) const { return l.hash(); }
+};
+
+template <typename StringT>
+struct hash<Airable::BasicLocationTrace<StringT>>
+{
+    size_t operator()(const Airable::BasicLocationTrace<StringT> &l) const { return l.hash(); }
+};
+
 }
 
 #endif /* !STRBO_URL_AIRABLE_HH */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_ANY_HH
+#define STRBO_URL_ANY_HH
+
+#include "strbo_url_usb.hh"
+#include "strbo_url_airable.hh"
+
+#include <variant>
+
+namespace StrBoUrl
+{
+
+/*!
+ * Value type which can hold any of the Streaming Board location types.
+ *
+ * Use this for storing locations of mixed types in contiguous containers.
+ * Access via \c std::visit() calls the location classes directly, without
+ * going through the virtual functions of #StrBoUrl::Location. The
+ * \c std::monostate alternative stands for "no location".
+ */
+using AnyLocation =
+    std::variant<std::monostate,
+                 USB::LocationKeySimple,
+                 USB::LocationKeyReference,
+                 USB::LocationTrace,
+                 Airable::LocationKeySimple,
+                 Airable::LocationKeyReference,
+                 Airable::LocationTrace>;
+
+static_assert(std::is_nothrow_move_constructible_v<AnyLocation>);
+
+/*!
+ * Access location stored in \p any through its base class.
+ *
+ * \returns
+ *     Pointer to the stored location, or \c nullptr if \p any does not
+ *     hold any location.
+ */
+static inline Location *get_location(AnyLocation &any) noexcept
+{
+    return std::visit(
+        [] (auto &l) -> Location *
+        {
+            if constexpr(std::is_same_v<std::decay_t<decltype(l)>, std::monostate>)
+                return nullptr;
+            else
+                return &l;
+        },
+        any);
+}
+
+static inline const Location *get_location(const AnyLocation &any) noexcept
+{
+    return get_location(const_cast<AnyLocation &>(any));
+}
+
+/*!
+ * Parse \p url into a location of type \p T stored in \p location.
+ *
+ * On error, \p location is reset to \c std::monostate.
+ */
+template <typename T>
+static inline ParseResult parse_into(std::string_view url, AnyLocation &location)
+{
+    const auto result = location.emplace<T>().try_set_url(url);
+
+    if(result.failed())
+        location = std::monostate();
+
+    return result;
+}
+
+}
+
+#endif /* !STRBO_URL_ANY_HH */
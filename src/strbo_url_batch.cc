@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_batch.hh"
+#include "strbo_url_registry.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <system_error>
+#include <thread>
+
+namespace
+{
+
+using SchemeId = StrBoUrl::Registry::SchemeId;
+
+static constexpr size_t NUMBER_OF_SCHEMES = size_t(SchemeId::HTTPS) + 1;
+
+/* number of URLs parsed in one go by a worker */
+static constexpr size_t CHUNK_SIZE = 256;
+
+/* batches smaller than this are not worth starting threads for */
+static constexpr size_t MIN_PARALLEL_BATCH_SIZE = 2 * CHUNK_SIZE;
+
+/*!
+ * Consecutive range in the scheme-sorted order of URLs.
+ */
+struct Chunk
+{
+    SchemeId scheme_;
+    uint32_t begin_;
+    uint32_t end_;
+};
+
+template <typename UrlT>
+class Job
+{
+  private:
+    const UrlT *const urls_;
+    std::vector<StrBoUrl::Batch::Entry> &entries_;
+
+    /* indices into urls_, sorted by scheme */
+    std::vector<uint32_t> order_;
+    std::vector<Chunk> chunks_;
+    std::atomic_size_t next_chunk_;
+
+  public:
+    Job(const Job &) = delete;
+    Job &operator=(const Job &) = delete;
+
+    explicit Job(const UrlT *urls, size_t count,
+                 std::vector<StrBoUrl::Batch::Entry> &entries):
+        urls_(urls),
+        entries_(entries),
+        order_(count),
+        next_chunk_(0)
+    {
+        group_by_scheme(count);
+    }
+
+    size_t get_number_of_chunks() const { return chunks_.size(); }
+
+    void run()
+    {
+        for(size_t i = next_chunk_++; i < chunks_.size(); i = next_chunk_++)
+            process(chunks_[i]);
+    }
+
+  private:
+    void group_by_scheme(size_t count)
+    {
+        std::vector<SchemeId> ids(count);
+        std::array<uint32_t, NUMBER_OF_SCHEMES + 1> first {};
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            ids[i] = StrBoUrl::Registry::identify(urls_[i]);
+            ++first[size_t(ids[i]) + 1];
+        }
+
+        for(size_t s = 1; s < first.size(); ++s)
+            first[s] += first[s - 1];
+
+        for(size_t s = 0; s < NUMBER_OF_SCHEMES; ++s)
+            for(uint32_t b = first[s]; b < first[s + 1]; b += CHUNK_SIZE)
+                chunks_.push_back({SchemeId(s), b,
+                                   std::min(uint32_t(b + CHUNK_SIZE), first[s + 1])});
+
+        for(size_t i = 0; i < count; ++i)
+            order_[first[size_t(ids[i])]++] = i;
+    }
+
+    template <typename T>
+    void parse_chunk(const Chunk &chunk)
+    {
+        for(uint32_t i = chunk.begin_; i < chunk.end_; ++i)
+        {
+            auto &e(entries_[order_[i]]);
+            e.result_ = StrBoUrl::parse_into<T>(urls_[order_[i]], e.location_);
+        }
+    }
+
+    void process(const Chunk &chunk)
+    {
+        switch(chunk.scheme_)
+        {
+          case SchemeId::USB_SIMPLE:
+            parse_chunk<USB::LocationKeySimple>(chunk);
+            return;
+
+          case SchemeId::USB_REFERENCE:
+            parse_chunk<USB::LocationKeyReference>(chunk);
+            return;
+
+          case SchemeId::USB_TRACE:
+            parse_chunk<USB::LocationTrace>(chunk);
+            return;
+
+          case SchemeId::AIRABLE_SIMPLE:
+            parse_chunk<Airable::LocationKeySimple>(chunk);
+            return;
+
+          case SchemeId::AIRABLE_REFERENCE:
+            parse_chunk<Airable::LocationKeyReference>(chunk);
+            return;
+
+          case SchemeId::AIRABLE_TRACE:
+            parse_chunk<Airable::LocationTrace>(chunk);
+            return;
+
+          case SchemeId::UNKNOWN:
+          case SchemeId::HTTP:
+          case SchemeId::HTTPS:
+            break;
+        }
+
+        for(uint32_t i = chunk.begin_; i < chunk.end_; ++i)
+            entries_[order_[i]].result_ =
+                StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::WRONG_SCHEME,
+                                      StrBoUrl::ParseResult::Component::URL, 0);
+    }
+};
+
+}
+
+template <typename UrlT>
+static std::vector<StrBoUrl::Batch::Entry>
+parse_batch(const UrlT *urls, size_t count, unsigned int num_workers)
+{
+    /* URLs are indexed by 32 bit numbers internally */
+    if(count > UINT32_MAX)
+        return std::vector<StrBoUrl::Batch::Entry>();
+
+    std::vector<StrBoUrl::Batch::Entry> entries(count);
+    Job<UrlT> job(urls, count, entries);
+
+    if(num_workers == 0)
+        num_workers = std::max(std::thread::hardware_concurrency(), 1U);
+
+    if(count < MIN_PARALLEL_BATCH_SIZE)
+        num_workers = 1;
+    else
+        num_workers = std::min(size_t(num_workers), job.get_number_of_chunks());
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers - 1);
+
+    for(unsigned int i = 1; i < num_workers; ++i)
+    {
+#ifdef __cpp_exceptions
+        try
+        {
+            threads.emplace_back([&job] { job.run(); });
+        }
+        catch(const std::system_error &)
+        {
+            /* carry on with the threads we have, chunks are distributed
+             * dynamically and the calling thread takes part anyway */
+            break;
+        }
+#else /* !__cpp_exceptions */
+        threads.emplace_back([&job] { job.run(); });
+#endif /* __cpp_exceptions */
+    }
+
+    job.run();
+
+    for(auto &t : threads)
+        t.join();
+
+    return entries;
+}
+
+std::vector<StrBoUrl::Batch::Entry>
+StrBoUrl::Batch::parse(const std::string_view *urls, size_t count,
+                       unsigned int num_workers)
+{
+    return parse_batch(urls, count, num_workers);
+}
+
+std::vector<StrBoUrl::Batch::Entry>
+StrBoUrl::Batch::parse(const std::string *urls, size_t count,
+                       unsigned int num_workers)
+{
+    return parse_batch(urls, count, num_workers);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_BATCH_HH
+#define STRBO_URL_BATCH_HH
+
+#include "strbo_url_any.hh"
+
+#include <string>
+#include <vector>
+
+namespace StrBoUrl
+{
+
+/*!
+ * Parsing of large numbers of URLs of mixed schemes.
+ */
+namespace Batch
+{
+
+/*!
+ * Outcome of parsing a single URL of a batch.
+ */
+struct Entry
+{
+    AnyLocation location_;
+    ParseResult result_;
+};
+
+/*!
+ * Parse \p count URLs in parallel.
+ *
+ * The URLs are grouped by scheme first, then each group is parsed in a loop
+ * specialized for its location type. The groups are cut into chunks which
+ * are distributed over up to \p num_workers threads, including the calling
+ * thread. Small batches are parsed on the calling thread only. If threads
+ * cannot be created, the threads started so far do all the work.
+ *
+ * \param urls
+ *     Array of URLs of any scheme supported by #StrBoUrl::AnyLocation.
+ *
+ * \param count
+ *     Number of URLs in \p urls. Batches of 2^32 or more URLs are rejected
+ *     with an empty result.
+ *
+ * \param num_workers
+ *     Maximum number of threads to use. Pass 0 to use as many threads as
+ *     there are CPU cores.
+ *
+ * \returns
+ *     One entry per URL, in input order. URLs with unknown scheme yield
+ *     #StrBoUrl::ParseResult::Code::WRONG_SCHEME.
+ */
+std::vector<Entry> parse(const std::string_view *urls, size_t count,
+                         unsigned int num_workers = 0);
+
+/*!
+ * Parse \p count URLs stored as \c std::string in parallel.
+ */
+std::vector<Entry> parse(const std::string *urls, size_t count,
+                         unsigned int num_workers = 0);
+
+static inline std::vector<Entry>
+parse(const std::vector<std::string> &urls, unsigned int num_workers = 0)
+{
+    return parse(urls.data(), urls.size(), num_workers);
+}
+
+static inline std::vector<Entry>
+parse(const std::vector<std::string_view> &urls, unsigned int num_workers = 0)
+{
+    return parse(urls.data(), urls.size(), num_workers);
+}
+
+}
+
+}
+
+#endif /* !STRBO_URL_BATCH_HH */
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_compressed.hh"
+
+uint8_t StrBoUrl::PrefixDictionary::find_longest_prefix(std::string_view url) const noexcept
+{
+    uint8_t best_id = 0;
+    size_t best_length = 0;
+
+    for(size_t i = 0; i < size_; ++i)
+    {
+        const auto &p(prefixes_[i]);
+
+        if(p.length() > best_length && p.length() <= url.length() &&
+           url.compare(0, p.length(), p) == 0)
+        {
+            best_id = i + 1;
+            best_length = p.length();
+        }
+    }
+
+    return best_id;
+}
+
+static constexpr std::string_view default_prefixes[] =
+{
+    "https://",
+    "http://",
+    "https://api.airable.io/",
+    "http://api.airable.io/",
+};
+
+static constexpr StrBoUrl::PrefixDictionary default_dictionary(default_prefixes);
+
+const StrBoUrl::PrefixDictionary &Airable::get_default_prefixes()
+{
+    return default_dictionary;
+}
+
+/*
+ * Compress URLs passed by \p for_each_url to its callback.
+ *
+ * The prefixes are looked up in a first pass so that the suffixes can be
+ * stored without wasting space.
+ */
+template <typename ForEachFn>
+void Airable::CompressedLocation::compress(Kind kind, size_t number_of_urls,
+                                           const ForEachFn &for_each_url)
+{
+    clear();
+    fields_.reserve(number_of_urls);
+
+    size_t end = 0;
+    for_each_url(
+        [this, &end] (std::string_view url, StrBoUrl::ObjectIndex position)
+        {
+            const uint8_t id = dict_->find_longest_prefix(url);
+            end += url.length() - dict_->get(id).length();
+            fields_.push_back(Field{uint32_t(end), position.get_object_index(), id});
+        });
+
+    /* suffix offsets are stored in 32 bits; each URL is shorter than the
+     * total, so checking the sum is enough */
+    if(end > UINT32_MAX)
+    {
+        clear();
+        return;
+    }
+
+    suffixes_.reserve(end);
+
+    size_t i = 0;
+    for_each_url(
+        [this, &i] (std::string_view url, StrBoUrl::ObjectIndex)
+        {
+            url.remove_prefix(dict_->get(fields_[i++].prefix_).length());
+            suffixes_.append(url.data(), url.length());
+        });
+
+    kind_ = kind;
+}
+
+template <typename StringT>
+void Airable::CompressedLocation::set(const BasicLocationKeySimple<StringT> &l)
+{
+    if(!l.is_valid())
+    {
+        clear();
+        return;
+    }
+
+    const auto &c(l.unpack());
+    compress(Kind::SIMPLE, 1,
+             [&c] (const auto &apply) { apply(c.item_url_, StrBoUrl::ObjectIndex()); });
+}
+
+template <typename StringT>
+void Airable::CompressedLocation::set(const BasicLocationKeyReference<StringT> &l)
+{
+    if(!l.is_valid())
+    {
+        clear();
+        return;
+    }
+
+    const auto &c(l.unpack());
+    compress(Kind::REFERENCE, 2,
+             [&c] (const auto &apply)
+             {
+                 apply(c.containing_list_url_, StrBoUrl::ObjectIndex());
+                 apply(c.item_url_, c.item_position_);
+             });
+}
+
+template <typename StringT>
+void Airable::CompressedLocation::set(const BasicLocationTrace<StringT> &l)
+{
+    if(!l.is_valid())
+    {
+        clear();
+        return;
+    }
+
+    const auto &c(l.unpack());
+    compress(Kind::TRACE, c.trace_urls_.size() + 2,
+             [&c] (const auto &apply)
+             {
+                 apply(c.reference_point_url_, StrBoUrl::ObjectIndex());
+
+                 for(size_t i = 0; i < c.trace_urls_.size(); ++i)
+                     apply(c.trace_urls_.get_url(i), c.trace_urls_.get_position(i));
+
+                 apply(c.item_url_, c.item_position_);
+             });
+}
+
+template <typename StringT>
+bool Airable::CompressedLocation::expand(BasicLocationKeySimple<StringT> &l) const
+{
+    l.clear();
+
+    if(kind_ != Kind::SIMPLE)
+        return false;
+
+    l.set_item(expand_url<StringT>(0));
+    return true;
+}
+
+template <typename StringT>
+bool Airable::CompressedLocation::expand(BasicLocationKeyReference<StringT> &l) const
+{
+    l.clear();
+
+    if(kind_ != Kind::REFERENCE)
+        return false;
+
+    l.set_containing_list(expand_url<StringT>(0));
+    l.set_item(expand_url<StringT>(1), get_position(1));
+    return true;
+}
+
+template <typename StringT>
+bool Airable::CompressedLocation::expand(BasicLocationTrace<StringT> &l) const
+{
+    l.clear();
+
+    if(kind_ != Kind::TRACE)
+        return false;
+
+    const size_t item = fields_.size() - 1;
+
+    l.set_reference_point(expand_url<StringT>(0));
+
+    for(size_t i = 1; i < item; ++i)
+        l.append_to_trace(expand_url<StringT>(i), get_position(i));
+
+    l.set_item(expand_url<StringT>(item), get_position(item));
+    return true;
+}
+
+std::string Airable::CompressedLocation::get_url(size_t i) const
+{
+    return expand_url<std::string>(i);
+}
+
+bool Airable::CompressedLocation::url_equals(size_t i, std::string_view url) const
+{
+    const auto prefix(dict_->get(fields_[i].prefix_));
+    const auto suffix(get_suffix(i));
+
+    return url.length() == prefix.length() + suffix.length() &&
+           url.compare(0, prefix.length(), prefix) == 0 &&
+           url.compare(prefix.length(), suffix.length(), suffix) == 0;
+}
+
+std::string Airable::CompressedLocation::str() const
+{
+    std::string result;
+
+    switch(kind_)
+    {
+      case Kind::INVALID:
+        break;
+
+      case Kind::SIMPLE:
+        {
+            LocationKeySimple l;
+            expand(l);
+            l.str_into(result);
+            break;
+        }
+
+      case Kind::REFERENCE:
+        {
+            LocationKeyReference l;
+            expand(l);
+            l.str_into(result);
+            break;
+        }
+
+      case Kind::TRACE:
+        {
+            LocationTrace l;
+            expand(l);
+            l.str_into(result);
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void write_varint(std::string &dest, uint32_t value)
+{
+    while(value >= 0x80)
+    {
+        dest.push_back(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    dest.push_back(char(value));
+}
+
+static bool read_varint(std::string_view data, size_t &pos, uint32_t &value)
+{
+    value = 0;
+
+    for(unsigned shift = 0; shift < 32 && pos < data.length(); shift += 7)
+    {
+        const uint8_t byte = data[pos++];
+
+        /* the fifth byte carries only the four most significant bits */
+        if(shift == 28 && (byte & 0x70) != 0)
+            return false;
+
+        value |= uint32_t(byte & 0x7f) << shift;
+
+        if((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Format: kind, number of URLs, and for each URL its prefix id, the length
+ * of its suffix, the suffix, and its position. Numbers other than the kind
+ * and the prefix ids are written as LEB128.
+ */
+void Airable::CompressedLocation::serialize_compact(std::string &dest) const
+{
+    dest.push_back(char(kind_));
+
+    if(kind_ == Kind::INVALID)
+        return;
+
+    write_varint(dest, fields_.size());
+
+    for(size_t i = 0; i < fields_.size(); ++i)
+    {
+        const auto suffix(get_suffix(i));
+
+        dest.push_back(char(fields_[i].prefix_));
+        write_varint(dest, suffix.length());
+        dest.append(suffix.data(), suffix.length());
+        write_varint(dest, fields_[i].position_);
+    }
+}
+
+StrBoUrl::ParseResult Airable::CompressedLocation::try_set_compact(std::string_view data)
+{
+    using Code = StrBoUrl::ParseResult::Code;
+    using Component = StrBoUrl::ParseResult::Component;
+
+    const auto fail =
+        [this] (Code code, size_t offset, Component component = Component::URL)
+        {
+            clear();
+            return StrBoUrl::ParseResult(code, component, offset);
+        };
+
+    clear();
+
+    if(data.empty())
+        return fail(Code::TRUNCATED_ENCODING, 0);
+
+    size_t pos = 0;
+    const auto kind = Kind(data[pos++]);
+    uint32_t number_of_urls = 0;
+
+    switch(kind)
+    {
+      case Kind::INVALID:
+        return pos < data.length()
+            ? fail(Code::TRAILING_JUNK, pos)
+            : StrBoUrl::ParseResult();
+
+      case Kind::SIMPLE:
+      case Kind::REFERENCE:
+      case Kind::TRACE:
+        if(!read_varint(data, pos, number_of_urls))
+            return fail(Code::TRUNCATED_ENCODING, pos);
+
+        break;
+
+      default:
+        return fail(Code::OUT_OF_RANGE, 0);
+    }
+
+    if((kind == Kind::SIMPLE && number_of_urls != 1) ||
+       (kind == Kind::REFERENCE && number_of_urls != 2) ||
+       (kind == Kind::TRACE && number_of_urls < 2) ||
+       number_of_urls > data.length() - pos)
+        return fail(Code::OUT_OF_RANGE, 1);
+
+    suffixes_.reserve(data.length() - pos);
+    fields_.reserve(number_of_urls);
+    kind_ = kind;
+
+    for(uint32_t i = 0; i < number_of_urls; ++i)
+    {
+        if(pos >= data.length())
+            return fail(Code::TRUNCATED_ENCODING, pos);
+
+        const uint8_t id = data[pos];
+
+        if(id > dict_->size())
+            return fail(Code::OUT_OF_RANGE, pos);
+
+        ++pos;
+
+        uint32_t length;
+        if(!read_varint(data, pos, length) || length > data.length() - pos)
+            return fail(Code::TRUNCATED_ENCODING, pos);
+
+        const auto suffix(data.substr(pos, length));
+        pos += length;
+
+        if(id == 0 && suffix.empty())
+            return fail(Code::COMPONENT_EMPTY, pos);
+
+        const size_t position_offset = pos;
+        uint32_t position;
+        if(!read_varint(data, pos, position))
+            return fail(Code::TRUNCATED_ENCODING, pos);
+
+        /* positions are mandatory for items and trace levels, and there are
+         * none for simple keys, containing lists, and reference points */
+        const bool need_position = kind != Kind::SIMPLE && i > 0;
+
+        if((position != 0) != need_position)
+            return fail(Code::OUT_OF_RANGE, position_offset, Component::ITEM_POSITION);
+
+        suffixes_.append(suffix.data(), suffix.length());
+        fields_.push_back(Field{uint32_t(suffixes_.length()), position, id});
+    }
+
+    if(pos < data.length())
+        return fail(Code::TRAILING_JUNK, pos);
+
+    return StrBoUrl::ParseResult();
+}
+
+template void Airable::CompressedLocation::set(const BasicLocationKeySimple<std::string> &);
+template void Airable::CompressedLocation::set(const BasicLocationKeySimple<std::pmr::string> &);
+template void Airable::CompressedLocation::set(const BasicLocationKeyReference<std::string> &);
+template void Airable::CompressedLocation::set(const BasicLocationKeyReference<std::pmr::string> &);
+template void Airable::CompressedLocation::set(const BasicLocationTrace<std::string> &);
+template void Airable::CompressedLocation::set(const BasicLocationTrace<std::pmr::string> &);
+template bool Airable::CompressedLocation::expand(BasicLocationKeySimple<std::string> &) const;
+template bool Airable::CompressedLocation::expand(BasicLocationKeySimple<std::pmr::string> &) const;
+template bool Airable::CompressedLocation::expand(BasicLocationKeyReference<std::string> &) const;
+template bool Airable::CompressedLocation::expand(BasicLocationKeyReference<std::pmr::string> &) const;
+template bool Airable::CompressedLocation::expand(BasicLocationTrace<std::string> &) const;
+template bool Airable::CompressedLocation::expand(BasicLocationTrace<std::pmr::string> &) const;
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_COMPRESSED_HH
+#define STRBO_URL_COMPRESSED_HH
+
+#include "strbo_url_airable.hh"
+
+
+namespace StrBoUrl
+{
+
+/*!
+ * Dictionary of well-known URL prefixes.
+ *
+ * Prefixes are identified by small numbers which replace the prefix in
+ * compressed representations of URLs. Id 0 stands for "no prefix", and the
+ * prefix at index \c i of the array passed to the constructor has id
+ * \c i + 1. Compact serializations stay valid for as long as prefixes are
+ * only ever appended to the array.
+ *
+ * The dictionary does not own its prefixes. It is meant to be defined as a
+ * \c constexpr object referring to a \c constexpr array so that it needs
+ * neither initialization at run time nor destruction.
+ */
+class PrefixDictionary
+{
+  public:
+    /*! Maximum number of prefixes in a dictionary. */
+    static constexpr size_t MAX_ENTRIES = 255;
+
+  private:
+    const std::string_view *prefixes_;
+    size_t size_;
+
+  public:
+    constexpr explicit PrefixDictionary():
+        prefixes_(nullptr),
+        size_(0)
+    {}
+
+    template <size_t N>
+    constexpr explicit PrefixDictionary(const std::string_view (&prefixes)[N]):
+        prefixes_(prefixes),
+        size_(N)
+    {
+        static_assert(N <= MAX_ENTRIES, "Too many prefixes");
+    }
+
+    constexpr size_t size() const { return size_; }
+
+    /*!
+     * Prefix with given id, or empty string for id 0 and unknown ids.
+     */
+    constexpr std::string_view get(uint8_t id) const
+    {
+        return id > 0 && id <= size_ ? prefixes_[id - 1] : std::string_view();
+    }
+
+    /*!
+     * Id of the longest prefix of \p url found in the dictionary, or 0.
+     */
+    uint8_t find_longest_prefix(std::string_view url) const noexcept;
+};
+
+}
+
+namespace Airable
+{
+
+/*!
+ * Prefixes shared by most URLs returned by the Airable API.
+ */
+const StrBoUrl::PrefixDictionary &get_default_prefixes();
+
+/*!
+ * Compressed representation of any Airable location.
+ *
+ * Each URL component is stored as the id of its longest prefix found in a
+ * #StrBoUrl::PrefixDictionary plus the remaining suffix. The suffixes of all
+ * components are kept back to back in a single string, and full URLs are
+ * expanded only on request. This is meant for holding many Airable locations
+ * in memory, e.g., large favorites lists, without repeating the API host
+ * and path in each trace level and each location.
+ *
+ * Components are numbered in URL order: the item URL for simple keys; the
+ * containing list and the item for reference keys; the reference point, the
+ * trace levels, and the item for traces.
+ *
+ * The dictionary must outlive the compressed location.
+ */
+class CompressedLocation
+{
+  public:
+    enum class Kind: uint8_t
+    {
+        INVALID,
+        SIMPLE,
+        REFERENCE,
+        TRACE,
+    };
+
+  private:
+    struct Field
+    {
+        uint32_t end_;
+        uint32_t position_;
+        uint8_t prefix_;
+    };
+
+    const StrBoUrl::PrefixDictionary *dict_;
+    std::string suffixes_;
+    std::vector<Field> fields_;
+    Kind kind_;
+
+  public:
+    explicit CompressedLocation(const StrBoUrl::PrefixDictionary &dict = get_default_prefixes()):
+        dict_(&dict),
+        kind_(Kind::INVALID)
+    {}
+
+    void clear()
+    {
+        suffixes_.clear();
+        fields_.clear();
+        kind_ = Kind::INVALID;
+    }
+
+    bool is_valid() const { return kind_ != Kind::INVALID; }
+    Kind get_kind() const { return kind_; }
+    const StrBoUrl::PrefixDictionary &get_dictionary() const { return *dict_; }
+
+    /*!
+     * Replace contents by compressed copy of \p l.
+     *
+     * Invalid locations yield an invalid compressed location, and so do
+     * locations whose URLs take more than 4 GiB after prefix removal.
+     */
+    template <typename StringT>
+    void set(const BasicLocationKeySimple<StringT> &l);
+
+    template <typename StringT>
+    void set(const BasicLocationKeyReference<StringT> &l);
+
+    template <typename StringT>
+    void set(const BasicLocationTrace<StringT> &l);
+
+    /*!
+     * Expand into \p l.
+     *
+     * \returns
+     *     False if the compressed location is of different kind, in which
+     *     case \p l is cleared.
+     */
+    template <typename StringT>
+    bool expand(BasicLocationKeySimple<StringT> &l) const;
+
+    template <typename StringT>
+    bool expand(BasicLocationKeyReference<StringT> &l) const;
+
+    template <typename StringT>
+    bool expand(BasicLocationTrace<StringT> &l) const;
+
+    /*!
+     * Number of URL components, including trace levels.
+     */
+    size_t get_number_of_urls() const { return fields_.size(); }
+
+    size_t get_trace_length() const
+    {
+        return kind_ == Kind::TRACE ? fields_.size() - 2 : 0;
+    }
+
+    uint8_t get_prefix_id(size_t i) const { return fields_[i].prefix_; }
+
+    std::string_view get_suffix(size_t i) const
+    {
+        const uint32_t begin = i > 0 ? fields_[i - 1].end_ : 0;
+        return std::string_view(suffixes_.data() + begin, fields_[i].end_ - begin);
+    }
+
+    StrBoUrl::ObjectIndex get_position(size_t i) const
+    {
+        return StrBoUrl::ObjectIndex(fields_[i].position_);
+    }
+
+    /*!
+     * Expanded URL of component \p i.
+     */
+    std::string get_url(size_t i) const;
+
+    /*!
+     * Compare component \p i with \p url without expanding it.
+     */
+    bool url_equals(size_t i, std::string_view url) const;
+
+    /*!
+     * Full location URL, or empty string for invalid locations.
+     */
+    std::string str() const;
+
+    /*!
+     * Append compact binary serialization to \p dest.
+     *
+     * Prefixes are written as their ids, so the serialization can only be
+     * read back using the same dictionary, or one with more prefixes
+     * appended to it.
+     */
+    void serialize_compact(std::string &dest) const;
+
+    /*!
+     * Set from data written by #Airable::CompressedLocation::serialize_compact().
+     *
+     * The location is invalid in case of error, and the offset of the
+     * result is the offending byte in \p data.
+     */
+    StrBoUrl::ParseResult try_set_compact(std::string_view data);
+
+    /*!
+     * Number of bytes allocated by the compressed location.
+     */
+    size_t get_memory_usage() const
+    {
+        return suffixes_.capacity() + fields_.capacity() * sizeof(Field);
+    }
+
+  private:
+    template <typename ForEachFn>
+    void compress(Kind kind, size_t number_of_urls, const ForEachFn &for_each_url);
+
+    template <typename StringT>
+    StringT expand_url(size_t i) const
+    {
+        StringT result;
+        const auto prefix(dict_->get(fields_[i].prefix_));
+        const auto suffix(get_suffix(i));
+        result.reserve(prefix.length() + suffix.length());
+        result.append(prefix.data(), prefix.length());
+        result.append(suffix.data(), suffix.length());
+        return result;
+    }
+};
+
+}
+
+#endif /* !STRBO_URL_COMPRESSED_HH */
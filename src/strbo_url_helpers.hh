@@ -22,20 +22,305 @@
 #ifndef STRBO_URL_HELPERS_HH
 #define STRBO_URL_HELPERS_HH
 
+#include "strbo_url.hh"
+#include "strbo_url_intern.hh"
+
 #include <string>
+#include <string_view>
+#include <array>
+#include <vector>
 #include <functional>
+#include <cinttypes>
+#include <cstring>
 
 namespace StrBoUrl
 {
 
-void for_each_url_encoded(const std::string &src,
+namespace Encoding
+{
+
+static constexpr std::array<bool, 256> make_character_table(std::string_view chars)
+{
+    std::array<bool, 256> table {};
+
+    for(const char ch : chars)
+        table[static_cast<uint8_t>(ch)] = true;
+
+    return table;
+}
+
+static constexpr std::array<uint8_t, 256> make_hex_values_table()
+{
+    std::array<uint8_t, 256> table {};
+
+    for(auto &v : table)
+        v = 0x80;
+
+    for(uint8_t i = 0; i < 10; ++i)
+        table['0' + i] = i;
+
+    for(uint8_t i = 0; i < 6; ++i)
+    {
+        table['A' + i] = 10 + i;
+        table['a' + i] = 10 + i;
+    }
+
+    return table;
+}
+
+/*!
+ * Characters which need no URL-encoding.
+ */
+inline constexpr auto safe_characters_table =
+    make_character_table(::StrBoUrl::Location::safe_characters);
+
+/*!
+ * Values of hexadecimal digits, both upper and lower case.
+ *
+ * All other characters map to values with bit 7 set.
+ */
+inline constexpr auto hex_values_table = make_hex_values_table();
+
+/*!
+ * Upper-case hexadecimal digits used in percent-encoded URL components.
+ */
+inline constexpr char hex_digits[] = "0123456789ABCDEF";
+
+/*!
+ * Return length of the longest prefix of \p src which needs no encoding.
+ *
+ * This is the workhorse of URL-encoding. It is vectorized where the target
+ * supports it, and falls back to a table lookup per byte otherwise. Both
+ * variants produce identical results for all byte values.
+ */
+size_t safe_prefix_length(const char *src, size_t len);
+
+/*!
+ * Return length of \p src after URL-encoding.
+ */
+size_t encoded_length(const char *src, size_t len);
+
+/*!
+ * URL-encode \p src to \p out, return pointer past the last byte written.
+ *
+ * The output buffer must have room for exactly the number of bytes
+ * returned by #StrBoUrl::Encoding::encoded_length().
+ */
+char *encode_into(const char *src, size_t len, char *out);
+
+/*!
+ * Decode a pair of hexadecimal digits.
+ */
+static inline bool decode_hex_pair(const char ch1, const char ch2, uint8_t &out)
+{
+    const uint8_t hi = hex_values_table[static_cast<uint8_t>(ch1)];
+    const uint8_t lo = hex_values_table[static_cast<uint8_t>(ch2)];
+    out = (hi << 4) | lo;
+    return ((hi | lo) & 0x80) == 0;
+}
+
+}
+
+/*!
+ * URL-encode \p src, passing the encoded data to \p apply in chunks.
+ *
+ * Runs of safe characters are passed on unmodified and in one piece, escaped
+ * characters are passed on in groups. The chunks need to be concatenated by
+ * the caller to form the encoded string.
+ *
+ * The callback may be any callable taking a pointer and a length.
+ */
+template <typename ApplyFn>
+void for_each_url_encoded(std::string_view src, ApplyFn &&apply)
+{
+    const char *pos = src.data();
+    const char *const end = pos + src.length();
+
+    while(pos < end)
+    {
+        const size_t safe_length = Encoding::safe_prefix_length(pos, end - pos);
+
+        if(safe_length > 0)
+        {
+            apply(static_cast<const char *>(pos), safe_length);
+            pos += safe_length;
+        }
+
+        /* escape run of unsafe characters in chunks */
+        char buffer[3 * 16];
+        size_t len = 0;
+
+        while(pos < end && len < sizeof(buffer) &&
+              !Encoding::safe_characters_table[static_cast<uint8_t>(*pos)])
+        {
+            const uint8_t ch = *pos++;
+            buffer[len++] = '%';
+            buffer[len++] = Encoding::hex_digits[ch >> 4];
+            buffer[len++] = Encoding::hex_digits[ch & 0x0f];
+        }
+
+        if(len > 0)
+            apply(static_cast<const char *>(buffer), len);
+    }
+}
+
+void for_each_url_encoded(std::string_view src,
                           const std::function<void(const char *, size_t)> &apply);
 
-void for_each_url_decoded(const std::string &src,
+/*!
+ * URL-decode \p src, passing each decoded character to \p apply.
+ *
+ * The callbacks may be any callables taking a \c char, and a
+ * #StrBoUrl::ParseResult::Code and a pointer to the offending escape
+ * sequence, respectively. Decoding stops at the first error.
+ */
+template <typename ApplyFn, typename ErrorFn>
+void for_each_url_decoded(std::string_view src, ApplyFn &&apply,
+                          ErrorFn &&on_decode_error)
+{
+    for(size_t i = 0; i < src.length(); ++i)
+    {
+        const char ch = src[i];
+
+        if(ch != '%')
+        {
+            apply(ch);
+            continue;
+        }
+
+        if(i + 3 <= src.length())
+        {
+            uint8_t out;
+
+            if(Encoding::decode_hex_pair(src[i + 1], src[i + 2], out))
+            {
+                i += 2;
+                apply(static_cast<char>(out));
+                continue;
+            }
+
+            on_decode_error(ParseResult::Code::INVALID_ENCODING, src.data() + i);
+        }
+        else
+            on_decode_error(ParseResult::Code::TRUNCATED_ENCODING, src.data() + i);
+
+        break;
+    }
+}
+
+void for_each_url_decoded(std::string_view src,
                           const std::function<void(char)> &apply,
-                          const std::function<void(std::string &&error)> &on_decode_error);
+                          const std::function<void(ParseResult::Code, const char *where)> &on_decode_error);
+
+/*!
+ * URL-decode \p len bytes at \p src, replacing the contents of \p dest.
+ *
+ * Unescaped runs are copied in one piece, and the destination is sized only
+ * once because the decoded string is never longer than its encoded form.
+ * Upper and lower case hexadecimal digits are accepted.
+ *
+ * In case of decoding errors, \p on_decode_error is called with an error
+ * code and a pointer to the offending escape sequence, and \c false is
+ * returned. The destination string contains everything decoded up to the
+ * error in this case.
+ */
+template <typename ErrorFn>
+bool url_decode(const char *src, size_t len, std::string &dest,
+                ErrorFn &&on_decode_error)
+{
+    /* decoded string is never longer than its encoded form */
+    dest.resize(len);
+
+    char *out = &dest[0];
+    const char *pos = src;
+    const char *const end = src + len;
+    bool success = true;
+
+    while(pos < end)
+    {
+        const auto *percent =
+            static_cast<const char *>(memchr(pos, '%', end - pos));
+        const size_t run_length = (percent != nullptr ? percent : end) - pos;
+
+        memcpy(out, pos, run_length);
+        out += run_length;
+
+        if(percent == nullptr)
+            break;
+
+        if(end - percent < 3)
+        {
+            on_decode_error(ParseResult::Code::TRUNCATED_ENCODING, percent);
+            success = false;
+            break;
+        }
+
+        uint8_t ch;
+
+        if(!Encoding::decode_hex_pair(percent[1], percent[2], ch))
+        {
+            on_decode_error(ParseResult::Code::INVALID_ENCODING, percent);
+            success = false;
+            break;
+        }
+
+        *out++ = ch;
+        pos = percent + 3;
+    }
 
-class ObjectIndex;
+    dest.resize(out - dest.data());
+
+    return success;
+}
+
+bool url_decode(const char *src, size_t len, std::string &dest,
+                const std::function<void(ParseResult::Code, const char *where)> &on_decode_error);
+
+/*!
+ * URL-decode \p len bytes at \p src, passing the decoded data to \p apply in
+ * chunks.
+ *
+ * This function is meant for data which has been validated before, so there
+ * is no error reporting. Unescaped runs are passed on in one piece, escaped
+ * characters one by one. Invalid escape sequences are passed on verbatim.
+ *
+ * The callback may be any callable taking a pointer and a length.
+ */
+template <typename ApplyFn>
+void for_each_url_decoded_chunk(const char *src, size_t len, ApplyFn &&apply)
+{
+    const char *pos = src;
+    const char *const end = src + len;
+
+    while(pos < end)
+    {
+        const auto *percent =
+            static_cast<const char *>(memchr(pos, '%', end - pos));
+
+        if(percent == nullptr)
+        {
+            apply(pos, size_t(end - pos));
+            break;
+        }
+
+        if(percent > pos)
+            apply(pos, size_t(percent - pos));
+
+        uint8_t ch;
+
+        if(end - percent >= 3 && Encoding::decode_hex_pair(percent[1], percent[2], ch))
+        {
+            const char decoded = ch;
+            apply(&decoded, size_t(1));
+            pos = percent + 3;
+        }
+        else
+        {
+            apply(percent, size_t(1));
+            pos = percent + 1;
+        }
+    }
+}
 
 namespace Parse
 {
@@ -47,18 +332,470 @@ enum class FieldPolicy
     MUST_NOT_BE_EMPTY,
 };
 
+/*!
+ * Positions of structural characters in a URL.
+ *
+ * The index is filled in by a single pass over the URL which validates each
+ * character against #StrBoUrl::Location::valid_characters and records the
+ * positions of all colons, slashes, and percent signs on the way. Scheme
+ * parsers look up their separators in the index instead of searching the URL
+ * over and over again.
+ */
+class StructuralIndex
+{
+  public:
+    static constexpr size_t npos = std::string::npos;
+
+  private:
+    static constexpr size_t INLINE_CAPACITY = 64;
+
+    const char *url_;
+    size_t url_length_;
+
+    /* positions go to the vector only if there are too many of them */
+    std::array<uint32_t, INLINE_CAPACITY> inline_positions_;
+    std::vector<uint32_t> more_positions_;
+    size_t count_;
+
+  public:
+    StructuralIndex(const StructuralIndex &) = delete;
+    StructuralIndex &operator=(const StructuralIndex &) = delete;
+
+    explicit StructuralIndex():
+        url_(nullptr),
+        url_length_(0),
+        count_(0)
+    {}
+
+    /*!
+     * Validate and index \p url, starting at \p offset.
+     *
+     * The URL must remain valid and unchanged as long as the index is used,
+     * and it must be shorter than 2^32 bytes, which is checked by
+     * #StrBoUrl::Parse::begin_parse().
+     *
+     * \returns
+     *     #StrBoUrl::Parse::StructuralIndex::npos if all characters are
+     *     valid, the position of the first invalid character otherwise. The
+     *     index is incomplete in the latter case.
+     */
+    size_t scan(std::string_view url, size_t offset);
+
+    const char *url() const { return url_; }
+    size_t url_length() const { return url_length_; }
+
+    /*!
+     * Find first separator \p ch (colon, slash, or percent sign) in range
+     * [\p from, \p to).
+     */
+    size_t find(char ch, size_t from, size_t to = npos) const;
+
+  private:
+    const uint32_t *begin() const
+    {
+        return more_positions_.empty() ? inline_positions_.data() : more_positions_.data();
+    }
+
+    const uint32_t *end() const { return begin() + count_; }
+
+    void add(uint32_t pos)
+    {
+        if(count_ < INLINE_CAPACITY)
+            inline_positions_[count_] = pos;
+        else
+        {
+            if(count_ == INLINE_CAPACITY)
+            {
+                more_positions_.reserve(2 * INLINE_CAPACITY);
+                more_positions_.assign(inline_positions_.begin(), inline_positions_.end());
+            }
+
+            more_positions_.push_back(pos);
+        }
+
+        ++count_;
+    }
+};
+
+/*!
+ * Collect the first error reported by the parsing helpers.
+ *
+ * Positions reported by the helpers are turned into offsets relative to the
+ * beginning of the URL.
+ */
+class ErrorCollector
+{
+  private:
+    ParseResult result_;
+    const char *const url_;
+
+  public:
+    ErrorCollector(const ErrorCollector &) = delete;
+    ErrorCollector &operator=(const ErrorCollector &) = delete;
+
+    explicit ErrorCollector(const char *url):
+        url_(url)
+    {}
+
+    bool failed() const { return result_.failed(); }
+    const ParseResult &get_result() const { return result_; }
+
+    void set(ParseResult::Code code, ParseResult::Component component,
+             const char *where)
+    {
+        if(result_.is_ok())
+            result_ = ParseResult(code, component, where - url_);
+    }
+
+    /*!
+     * Return error callback for use with the parsing helpers.
+     */
+    auto in(ParseResult::Component component)
+    {
+        return [this, component] (ParseResult::Code code, const char *where)
+        {
+            set(code, component, where);
+        };
+    }
+};
+
+/*!
+ * Check the scheme of \p url and validate and index it for parsing.
+ *
+ * On success, \p offset is set to the position right after the "://"
+ * following the scheme name.
+ */
+ParseResult begin_parse(std::string_view url, const Schema::StrBoLocator &scheme,
+                        StructuralIndex &index, size_t &offset) noexcept;
+
+/*!
+ * Parse \p url into location view \p view.
+ *
+ * The view type must provide \c parse_fields() and \c clear() function
+ * members. In case of wrong scheme, the view is left untouched, it is
+ * cleared on any other error.
+ */
+template <typename ViewT>
+ParseResult parse_view(ViewT &view, std::string_view url,
+                       const Schema::StrBoLocator &scheme) noexcept
+{
+    StructuralIndex index;
+    size_t offset;
+    auto result = begin_parse(url, scheme, index, offset);
+
+    if(result.get_code() == ParseResult::Code::WRONG_SCHEME)
+        return result;
+
+    if(result.is_ok())
+        result = view.parse_fields(url, offset, index);
+
+    if(result.failed())
+        view.clear();
+
+    return result;
+}
+
+/*!
+ * Validate URL-encoding in range [\p from, \p to) without decoding.
+ *
+ * The percent signs are looked up in the index. The error callback is
+ * called for the first invalid or truncated escape sequence, in which case
+ * \c false is returned.
+ */
+template <typename ErrorFn>
+bool check_encoding(const StructuralIndex &index, size_t from, size_t to,
+                    ErrorFn &&on_decode_error)
+{
+    const char *const url = index.url();
+
+    for(size_t pos = index.find('%', from, to);
+        pos != StructuralIndex::npos;
+        pos = index.find('%', pos + 3, to))
+    {
+        if(to - pos < 3)
+        {
+            on_decode_error(ParseResult::Code::TRUNCATED_ENCODING, url + pos);
+            return false;
+        }
+
+        uint8_t ch;
+
+        if(!Encoding::decode_hex_pair(url[pos + 1], url[pos + 2], ch))
+        {
+            on_decode_error(ParseResult::Code::INVALID_ENCODING, url + pos);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * Whether or not encoded \p field decodes to a single slash.
+ */
+static inline bool is_encoded_root(std::string_view field)
+{
+    return field == "/" ||
+           (field.length() == 3 && field[0] == '%' && field[1] == '2' &&
+            (field[2] == 'F' || field[2] == 'f'));
+}
+
+/*!
+ * Whether or not encoded \p field contains an escaped slash.
+ */
+static inline bool contains_encoded_slash(std::string_view field)
+{
+    for(size_t pos = field.find('%'); pos != std::string_view::npos;
+        pos = field.find('%', pos + 1))
+    {
+        if(pos + 2 < field.length() && field[pos + 1] == '2' &&
+           (field[pos + 2] == 'F' || field[pos + 2] == 'f'))
+            return true;
+    }
+
+    return false;
+}
+
+/*!
+ * Find end of field starting at \p offset, terminated by \p separator.
+ *
+ * The error callback may be any callable taking a
+ * #StrBoUrl::ParseResult::Code and a pointer into the URL.
+ */
+template <typename ErrorFn>
+std::string::size_type
+extract_field(const StructuralIndex &index, size_t offset, const char separator,
+              FieldPolicy policy, ErrorFn &&on_error)
+{
+    const auto end_of_field = index.find(separator, offset);
+
+    if(end_of_field == std::string::npos)
+    {
+        switch(policy)
+        {
+          case FieldPolicy::FIELD_OPTIONAL:
+            break;
+
+          case FieldPolicy::MAY_BE_EMPTY:
+          case FieldPolicy::MUST_NOT_BE_EMPTY:
+            on_error(separator == ':'
+                     ? ParseResult::Code::NO_COLON
+                     : ParseResult::Code::NO_SLASH,
+                     index.url() + offset);
+            break;
+        }
+    }
+    else
+    {
+        switch(policy)
+        {
+          case FieldPolicy::FIELD_OPTIONAL:
+          case FieldPolicy::MAY_BE_EMPTY:
+            break;
+
+          case FieldPolicy::MUST_NOT_BE_EMPTY:
+            if(end_of_field <= offset)
+            {
+                on_error(ParseResult::Code::COMPONENT_EMPTY, index.url() + offset);
+                return std::string::npos;
+            }
+
+            break;
+        }
+    }
+
+    return end_of_field;
+}
+
 std::string::size_type
-extract_field(const std::string &url, size_t offset, const char separator,
+extract_field(const StructuralIndex &index, size_t offset, const char separator,
               FieldPolicy policy,
-              const std::function<void(const char *error_message)> &on_error);
+              const std::function<void(ParseResult::Code, const char *where)> &on_error);
+
+/*!
+ * Parse item position in range [\p offset, \p expected_end).
+ *
+ * The error callback may be any callable taking a
+ * #StrBoUrl::ParseResult::Code and a pointer into the URL.
+ */
+template <typename ErrorFn>
+StrBoUrl::ObjectIndex
+item_position(std::string_view url, size_t offset, size_t expected_end,
+              ErrorFn &&on_error)
+{
+    StrBoUrl::ObjectIndex result;
+    const char *where;
+    const auto code =
+        StrBoUrl::ObjectIndex::from_chars(url.data() + offset,
+                                          url.data() + expected_end,
+                                          result, where);
+
+    if(code != ParseResult::Code::OK)
+        on_error(code, where);
+
+    return result;
+}
 
+/*!
+ * Parse item position from \p offset to the end of the URL.
+ *
+ * The error callback may be any callable taking a
+ * #StrBoUrl::ParseResult::Code and a pointer into the URL.
+ */
+template <typename ErrorFn>
 StrBoUrl::ObjectIndex
-item_position(const std::string &url, size_t offset, size_t expected_end,
-              const std::function<void(const char *error_message)> &on_error);
+item_position(std::string_view url, size_t offset, ErrorFn &&on_error)
+{
+    return item_position(url, offset, url.length(), on_error);
+}
 
 StrBoUrl::ObjectIndex
-item_position(const std::string &url, size_t offset,
-              const std::function<void(const char *error_message)> &on_error);
+item_position(std::string_view url, size_t offset, size_t expected_end,
+              const std::function<void(ParseResult::Code, const char *where)> &on_error);
+
+StrBoUrl::ObjectIndex
+item_position(std::string_view url, size_t offset,
+              const std::function<void(ParseResult::Code, const char *where)> &on_error);
+
+}
+
+namespace Serialize
+{
+
+/*!
+ * Sink which only counts the bytes passed to it.
+ */
+class LengthSink
+{
+  private:
+    size_t length_;
+
+  public:
+    explicit LengthSink(): length_(0) {}
+
+    void operator()(const char *, size_t len) { length_ += len; }
+
+    size_t get_length() const { return length_; }
+};
+
+/*!
+ * Sink which copies the bytes passed to it to a sufficiently large buffer.
+ */
+class BufferSink
+{
+  private:
+    char *pos_;
+
+  public:
+    explicit BufferSink(char *buffer): pos_(buffer) {}
+
+    void operator()(const char *src, size_t len)
+    {
+        memcpy(pos_, src, len);
+        pos_ += len;
+    }
+
+    void encoded(std::string_view src)
+    {
+        pos_ = Encoding::encode_into(src.data(), src.length(), pos_);
+    }
+};
+
+/*!
+ * Type-erased sink for consumers other than length counting and writing.
+ *
+ * Item positions may be left out, e.g., for hashing locations regardless of
+ * their position hints.
+ */
+class ChunkSink
+{
+  public:
+    using ConsumeFn = void (*)(void *context, const char *src, size_t len);
+
+  private:
+    ConsumeFn consume_;
+    void *context_;
+    bool skip_positions_;
+
+  public:
+    explicit ChunkSink(ConsumeFn consume, void *context, bool skip_positions = false):
+        consume_(consume),
+        context_(context),
+        skip_positions_(skip_positions)
+    {}
+
+    void operator()(const char *src, size_t len) { consume_(context_, src, len); }
+
+    bool is_skipping_positions() const { return skip_positions_; }
+};
+
+/*!
+ * Whether or not \p sink wants to see item positions.
+ */
+template <typename SinkFn>
+bool wants_positions(const SinkFn &) { return true; }
+
+static inline bool wants_positions(const ChunkSink &sink) { return !sink.is_skipping_positions(); }
+
+/*!
+ * Pass scheme name followed by "://" to \p sink.
+ */
+template <typename SinkFn>
+void scheme(SinkFn &sink, const Schema::StrBoLocator &s)
+{
+    const auto name(s.get_scheme_name());
+    sink(name.data(), name.length());
+    sink("://", size_t(3));
+}
+
+template <typename SinkFn>
+void character(SinkFn &sink, char ch)
+{
+    sink(&ch, size_t(1));
+}
+
+/*!
+ * Pass URL-encoded \p src to \p sink.
+ */
+template <typename SinkFn>
+void encoded(SinkFn &sink, std::string_view src)
+{
+    for_each_url_encoded(src, sink);
+}
+
+static inline void encoded(LengthSink &sink, std::string_view src)
+{
+    sink(nullptr, Encoding::encoded_length(src.data(), src.length()));
+}
+
+static inline void encoded(BufferSink &sink, std::string_view src)
+{
+    sink.encoded(src);
+}
+
+/*!
+ * Pass cached encoded form of interned string to \p sink.
+ */
+template <typename SinkFn>
+void encoded(SinkFn &sink, const InternedString &src)
+{
+    const auto enc(src.get_encoded());
+    sink(enc.data(), enc.length());
+}
+
+/*!
+ * Pass decimal representation of \p idx to \p sink.
+ */
+template <typename SinkFn>
+void position(SinkFn &sink, ObjectIndex idx)
+{
+    if(!wants_positions(sink))
+        return;
+
+    char buffer[ObjectIndex::MAX_CHARS];
+    const char *end = idx.to_chars(buffer, buffer + sizeof(buffer));
+    sink(static_cast<const char *>(buffer), size_t(end - buffer));
+}
 
 }
 
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_intern.hh"
+#include "strbo_url_helpers.hh"
+
+#include <functional>
+
+#include <pthread.h>
+
+namespace
+{
+
+/*
+ * Entries are chained into fixed-size hash tables; only few distinct strings
+ * are expected, so the tables are never resized.
+ *
+ * The pool is constant-initialized, so it needs neither a static constructor
+ * nor a guard variable, and it is never destroyed so that handles in objects
+ * with static storage duration remain valid until the very end.
+ */
+template <typename EntryT>
+class Pool
+{
+  public:
+    static constexpr size_t NUMBER_OF_BUCKETS = 256;
+
+    pthread_mutex_t lock_;
+    EntryT *by_decoded_[NUMBER_OF_BUCKETS];
+    EntryT *by_encoded_[NUMBER_OF_BUCKETS];
+    size_t size_;
+
+    constexpr explicit Pool():
+        lock_ PTHREAD_MUTEX_INITIALIZER,
+        by_decoded_{},
+        by_encoded_{},
+        size_(0)
+    {}
+
+    static size_t bucket(size_t hash) { return (hash >> 4) % NUMBER_OF_BUCKETS; }
+
+    EntryT *find_by_decoded(size_t hash, std::string_view decoded) const
+    {
+        for(EntryT *e = by_decoded_[bucket(hash)]; e != nullptr; e = e->next_by_decoded_)
+            if(e->decoded_hash_ == hash && e->decoded_ == decoded)
+                return e;
+
+        return nullptr;
+    }
+
+    EntryT *find_by_encoded(size_t hash, std::string_view encoded) const
+    {
+        for(EntryT *e = by_encoded_[bucket(hash)]; e != nullptr; e = e->next_by_encoded_)
+            if(e->encoded_hash_ == hash && e->encoded_ == encoded)
+                return e;
+
+        return nullptr;
+    }
+
+    void insert(EntryT *entry)
+    {
+        auto &decoded_head(by_decoded_[bucket(entry->decoded_hash_)]);
+        entry->next_by_decoded_ = decoded_head;
+        decoded_head = entry;
+
+        auto &encoded_head(by_encoded_[bucket(entry->encoded_hash_)]);
+        entry->next_by_encoded_ = encoded_head;
+        encoded_head = entry;
+
+        ++size_;
+    }
+
+    void remove(EntryT *entry)
+    {
+        unlink(by_decoded_[bucket(entry->decoded_hash_)], entry, &EntryT::next_by_decoded_);
+        unlink(by_encoded_[bucket(entry->encoded_hash_)], entry, &EntryT::next_by_encoded_);
+        --size_;
+    }
+
+  private:
+    static void unlink(EntryT *&head, EntryT *entry, EntryT *EntryT::*next)
+    {
+        for(EntryT **e = &head; *e != nullptr; e = &((*e)->*next))
+        {
+            if(*e == entry)
+            {
+                *e = entry->*next;
+                return;
+            }
+        }
+    }
+};
+
+template <typename EntryT>
+Pool<EntryT> pool;
+
+class PoolLock
+{
+  private:
+    pthread_mutex_t &lock_;
+
+  public:
+    PoolLock(const PoolLock &) = delete;
+    PoolLock &operator=(const PoolLock &) = delete;
+
+    explicit PoolLock(pthread_mutex_t &lock):
+        lock_(lock)
+    {
+        pthread_mutex_lock(&lock_);
+    }
+
+    ~PoolLock() { pthread_mutex_unlock(&lock_); }
+};
+
+}
+
+static size_t hash_string(std::string_view str)
+{
+    return std::hash<std::string_view>()(str);
+}
+
+StrBoUrl::InternedString::Entry *
+StrBoUrl::InternedString::intern(std::string_view decoded)
+{
+    if(decoded.empty())
+        return nullptr;
+
+    const size_t decoded_hash = hash_string(decoded);
+
+    {
+        PoolLock lock(pool<Entry>.lock_);
+        Entry *entry = pool<Entry>.find_by_decoded(decoded_hash, decoded);
+
+        if(entry != nullptr)
+        {
+            entry->refcount_.fetch_add(1, std::memory_order_relaxed);
+            return entry;
+        }
+    }
+
+    /* encode without holding the lock */
+    std::string encoded(Encoding::encoded_length(decoded.data(), decoded.length()), '\0');
+    Encoding::encode_into(decoded.data(), decoded.length(), &encoded[0]);
+    const size_t encoded_hash = hash_string(encoded);
+
+    PoolLock lock(pool<Entry>.lock_);
+
+    /* another thread may have been faster */
+    Entry *entry = pool<Entry>.find_by_decoded(decoded_hash, decoded);
+
+    if(entry != nullptr)
+    {
+        entry->refcount_.fetch_add(1, std::memory_order_relaxed);
+        return entry;
+    }
+
+    entry = new Entry(decoded, std::move(encoded), decoded_hash, encoded_hash);
+    pool<Entry>.insert(entry);
+
+    return entry;
+}
+
+StrBoUrl::InternedString
+StrBoUrl::InternedString::from_encoded(std::string_view encoded)
+{
+    InternedString result;
+
+    if(encoded.empty())
+        return result;
+
+    {
+        const size_t hash = hash_string(encoded);
+        PoolLock lock(pool<Entry>.lock_);
+        result.entry_ = pool<Entry>.find_by_encoded(hash, encoded);
+
+        if(result.entry_ != nullptr)
+        {
+            result.entry_->refcount_.fetch_add(1, std::memory_order_relaxed);
+            return result;
+        }
+    }
+
+    /* not in the pool, or not in canonical encoding */
+    std::string decoded;
+
+    if(url_decode(encoded.data(), encoded.length(), decoded,
+                  [] (ParseResult::Code, const char *) {}))
+        result.entry_ = intern(decoded);
+
+    return result;
+}
+
+void StrBoUrl::InternedString::release(Entry *entry)
+{
+    if(entry == nullptr)
+        return;
+
+    /* fast path: not the last reference, no need to lock */
+    uint32_t count = entry->refcount_.load(std::memory_order_relaxed);
+
+    while(count > 1)
+        if(entry->refcount_.compare_exchange_weak(count, count - 1,
+                                                  std::memory_order_acq_rel))
+            return;
+
+    /* possibly the last reference; lookups increment the count only while
+     * holding the lock, so the entry cannot be revived while we hold it */
+    {
+        PoolLock lock(pool<Entry>.lock_);
+
+        if(entry->refcount_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        pool<Entry>.remove(entry);
+    }
+
+    delete entry;
+}
+
+size_t StrBoUrl::InternedString::get_pool_size()
+{
+    PoolLock lock(pool<Entry>.lock_);
+    return pool<Entry>.size_;
+}
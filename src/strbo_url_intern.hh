@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_INTERN_HH
+#define STRBO_URL_INTERN_HH
+
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <type_traits>
+
+namespace StrBoUrl
+{
+
+/*!
+ * Reference-counted handle to a string in the global intern pool.
+ *
+ * Components which take only few distinct values, such as USB device and
+ * partition names, are stored once in the pool together with their
+ * URL-encoded form. Handles are the size of a pointer, copying a handle
+ * increments a reference count, and serialization copies the cached encoded
+ * form. Strings are removed from the pool when their last handle is gone.
+ *
+ * The empty string is represented without pool entry. Handles may be used
+ * from multiple threads; the pool is protected by a single lock, which is
+ * taken only for lookups and when the last handle of a string is gone.
+ */
+class InternedString
+{
+  private:
+    struct Entry
+    {
+        const std::string decoded_;
+        const std::string encoded_;
+        const size_t decoded_hash_;
+        const size_t encoded_hash_;
+        std::atomic<uint32_t> refcount_;
+
+        /* chains in the pool's hash tables */
+        Entry *next_by_decoded_;
+        Entry *next_by_encoded_;
+
+        explicit Entry(std::string_view decoded, std::string &&encoded,
+                       size_t decoded_hash, size_t encoded_hash):
+            decoded_(decoded),
+            encoded_(std::move(encoded)),
+            decoded_hash_(decoded_hash),
+            encoded_hash_(encoded_hash),
+            refcount_(1),
+            next_by_decoded_(nullptr),
+            next_by_encoded_(nullptr)
+        {}
+    };
+
+    Entry *entry_;
+
+  public:
+    constexpr explicit InternedString(): entry_(nullptr) {}
+
+    /*!
+     * Empty string, for symmetry with allocator-aware string types.
+     */
+    explicit InternedString(const std::allocator<char> &): entry_(nullptr) {}
+
+    /*!
+     * Intern decoded string \p decoded.
+     */
+    explicit InternedString(std::string_view decoded):
+        entry_(intern(decoded))
+    {}
+
+    InternedString(const InternedString &src):
+        entry_(src.entry_)
+    {
+        if(entry_ != nullptr)
+            entry_->refcount_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    InternedString(InternedString &&src) noexcept:
+        entry_(src.entry_)
+    {
+        src.entry_ = nullptr;
+    }
+
+    InternedString &operator=(const InternedString &src)
+    {
+        InternedString temp(src);
+        std::swap(entry_, temp.entry_);
+        return *this;
+    }
+
+    InternedString &operator=(InternedString &&src) noexcept
+    {
+        std::swap(entry_, src.entry_);
+        return *this;
+    }
+
+    InternedString &operator=(std::string_view decoded)
+    {
+        return *this = InternedString(decoded);
+    }
+
+    ~InternedString() { release(entry_); }
+
+    /*!
+     * Intern string given in URL-encoded form.
+     *
+     * Strings which are encoded the same way as this library encodes them are
+     * found in the pool without decoding. Invalid encodings yield the empty
+     * string.
+     */
+    static InternedString from_encoded(std::string_view encoded);
+
+    void clear()
+    {
+        release(entry_);
+        entry_ = nullptr;
+    }
+
+    bool empty() const { return entry_ == nullptr; }
+
+    size_t length() const { return entry_ != nullptr ? entry_->decoded_.length() : 0; }
+
+    std::string_view get() const
+    {
+        return entry_ != nullptr ? std::string_view(entry_->decoded_) : std::string_view();
+    }
+
+    operator std::string_view() const { return get(); }
+
+    /*!
+     * Cached URL-encoded form of the string.
+     */
+    std::string_view get_encoded() const
+    {
+        return entry_ != nullptr ? std::string_view(entry_->encoded_) : std::string_view();
+    }
+
+    friend bool operator==(const InternedString &a, const InternedString &b) { return a.entry_ == b.entry_; }
+    friend bool operator!=(const InternedString &a, const InternedString &b) { return a.entry_ != b.entry_; }
+    friend bool operator==(const InternedString &a, std::string_view b) { return a.get() == b; }
+    friend bool operator!=(const InternedString &a, std::string_view b) { return a.get() != b; }
+
+    /*!
+     * Number of distinct strings currently in the pool.
+     */
+    static size_t get_pool_size();
+
+  private:
+    static Entry *intern(std::string_view decoded);
+    static void release(Entry *entry);
+};
+
+/*!
+ * Interned strings for the default string type, other strings unchanged.
+ *
+ * Strings with special allocators are not interned because the pool uses
+ * the global heap.
+ */
+template <typename StringT>
+using InternedStringFor =
+    std::conditional_t<std::is_same_v<StringT, std::string>, InternedString, StringT>;
+
+}
+
+#endif /* !STRBO_URL_INTERN_HH */
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_registry.hh"
+
+#include <cstring>
+
+namespace
+{
+
+struct Entry
+{
+    const StrBoUrl::Schema::StrBoLocator &(*get_scheme)();
+    std::unique_ptr<StrBoUrl::Location> (*create)();
+};
+
+template <typename T>
+static std::unique_ptr<StrBoUrl::Location> create_location()
+{
+    return std::unique_ptr<StrBoUrl::Location>(new T);
+}
+
+static const StrBoUrl::Schema::StrBoLocator &get_http_scheme()
+{
+    static constexpr Airable::ResourceLocatorHTTP scheme;
+    return scheme;
+}
+
+static const StrBoUrl::Schema::StrBoLocator &get_https_scheme()
+{
+    static constexpr Airable::ResourceLocatorHTTPS scheme;
+    return scheme;
+}
+
+/* indexed by StrBoUrl::Registry::SchemeId */
+static const Entry entries[] =
+{
+    { nullptr, nullptr },
+    { USB::LocationKeySimple::get_scheme, create_location<USB::LocationKeySimple> },
+    { USB::LocationKeyReference::get_scheme, create_location<USB::LocationKeyReference> },
+    { USB::LocationTrace::get_scheme, create_location<USB::LocationTrace> },
+    { Airable::LocationKeySimple::get_scheme, create_location<Airable::LocationKeySimple> },
+    { Airable::LocationKeyReference::get_scheme, create_location<Airable::LocationKeyReference> },
+    { Airable::LocationTrace::get_scheme, create_location<Airable::LocationTrace> },
+    { get_http_scheme, nullptr },
+    { get_https_scheme, nullptr },
+};
+
+static_assert(sizeof(entries) / sizeof(entries[0]) ==
+              size_t(StrBoUrl::Registry::SchemeId::HTTPS) + 1,
+              "Registry table does not match scheme IDs");
+
+/* length of the longest scheme name, "strbo-trace-airable" */
+static constexpr size_t MAX_SCHEME_NAME_LENGTH = 19;
+
+}
+
+StrBoUrl::Registry::SchemeId StrBoUrl::Registry::identify(std::string_view url) noexcept
+{
+    /* data() of an empty view may be a null pointer, not valid for memchr() */
+    if(url.empty())
+        return SchemeId::UNKNOWN;
+
+    const auto *colon = static_cast<const char *>(
+        memchr(url.data(), ':', std::min(url.length(), MAX_SCHEME_NAME_LENGTH + 1)));
+
+    if(colon == nullptr)
+        return SchemeId::UNKNOWN;
+
+    const size_t name_length = colon - url.data();
+    SchemeId candidate;
+
+    /* perfect hash over the registered scheme names: the length, and for
+     * the only two names of equal length, the character at position 6 */
+    switch(name_length)
+    {
+      case 4:
+        candidate = SchemeId::HTTP;
+        break;
+
+      case 5:
+        candidate = SchemeId::HTTPS;
+        break;
+
+      case 9:
+        candidate = SchemeId::USB_SIMPLE;
+        break;
+
+      case 13:
+        candidate = url[6] == 'r' ? SchemeId::USB_REFERENCE : SchemeId::AIRABLE_SIMPLE;
+        break;
+
+      case 15:
+        candidate = SchemeId::USB_TRACE;
+        break;
+
+      case 17:
+        candidate = SchemeId::AIRABLE_REFERENCE;
+        break;
+
+      case 19:
+        candidate = SchemeId::AIRABLE_TRACE;
+        break;
+
+      default:
+        return SchemeId::UNKNOWN;
+    }
+
+    if(url.length() < name_length + 3 || colon[1] != '/' || colon[2] != '/')
+        return SchemeId::UNKNOWN;
+
+    const auto name(entries[size_t(candidate)].get_scheme().get_scheme_name());
+
+    return memcmp(url.data(), name.data(), name_length) == 0
+        ? candidate
+        : SchemeId::UNKNOWN;
+}
+
+const StrBoUrl::Schema::StrBoLocator *
+StrBoUrl::Registry::get_scheme(SchemeId id) noexcept
+{
+    const auto &entry(entries[size_t(id)]);
+    return entry.get_scheme != nullptr ? &entry.get_scheme() : nullptr;
+}
+
+std::unique_ptr<StrBoUrl::Location> StrBoUrl::Registry::create(SchemeId id)
+{
+    const auto &entry(entries[size_t(id)]);
+    return entry.create != nullptr ? entry.create() : nullptr;
+}
+
+std::unique_ptr<StrBoUrl::Location>
+StrBoUrl::Registry::parse_any(std::string_view url, ParseResult &result)
+{
+    auto location = create(identify(url));
+
+    if(location == nullptr)
+    {
+        result = ParseResult(ParseResult::Code::WRONG_SCHEME,
+                             ParseResult::Component::URL, 0);
+        return nullptr;
+    }
+
+    result = location->try_set_url(url);
+
+    if(result.failed())
+        location.reset();
+
+    return location;
+}
+
+StrBoUrl::ParseResult
+StrBoUrl::Registry::parse_any(std::string_view url, AnyLocation &location)
+{
+    switch(identify(url))
+    {
+      case SchemeId::USB_SIMPLE:
+        return parse_into<USB::LocationKeySimple>(url, location);
+
+      case SchemeId::USB_REFERENCE:
+        return parse_into<USB::LocationKeyReference>(url, location);
+
+      case SchemeId::USB_TRACE:
+        return parse_into<USB::LocationTrace>(url, location);
+
+      case SchemeId::AIRABLE_SIMPLE:
+        return parse_into<Airable::LocationKeySimple>(url, location);
+
+      case SchemeId::AIRABLE_REFERENCE:
+        return parse_into<Airable::LocationKeyReference>(url, location);
+
+      case SchemeId::AIRABLE_TRACE:
+        return parse_into<Airable::LocationTrace>(url, location);
+
+      case SchemeId::UNKNOWN:
+      case SchemeId::HTTP:
+      case SchemeId::HTTPS:
+        break;
+    }
+
+    location = std::monostate();
+    return ParseResult(ParseResult::Code::WRONG_SCHEME,
+                       ParseResult::Component::URL, 0);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_REGISTRY_HH
+#define STRBO_URL_REGISTRY_HH
+
+#include "strbo_url_any.hh"
+
+#include <memory>
+
+namespace StrBoUrl
+{
+
+/*!
+ * Central registry of all known Streaming Board locator schemes.
+ *
+ * The registry identifies the scheme of a URL in constant time and creates
+ * matching location objects, so that callers do not need to know the type
+ * of a URL in advance.
+ */
+namespace Registry
+{
+
+enum class SchemeId: uint8_t
+{
+    UNKNOWN,
+    USB_SIMPLE,
+    USB_REFERENCE,
+    USB_TRACE,
+    AIRABLE_SIMPLE,
+    AIRABLE_REFERENCE,
+    AIRABLE_TRACE,
+    HTTP,
+    HTTPS,
+};
+
+/*!
+ * Identify the scheme of \p url.
+ *
+ * The scheme name is found by its length and a single distinguishing
+ * character, then verified by one memory comparison including the "://"
+ * separator. The cost does not depend on the number of registered schemes.
+ */
+SchemeId identify(std::string_view url) noexcept;
+
+/*!
+ * Return scheme object for given ID, \c nullptr for unknown schemes.
+ */
+const Schema::StrBoLocator *get_scheme(SchemeId id) noexcept;
+
+/*!
+ * Create empty location object for given scheme.
+ *
+ * \returns
+ *     A new location object, or \c nullptr for unknown schemes and for
+ *     schemes without location representation (\c http, \c https).
+ */
+std::unique_ptr<Location> create(SchemeId id);
+
+/*!
+ * Identify scheme of \p url and parse it into a matching location object.
+ *
+ * The outcome of parsing is returned in \p result. If the scheme is not
+ * known or has no location representation, then the result code is
+ * #StrBoUrl::ParseResult::Code::WRONG_SCHEME. In case of errors, \c nullptr
+ * is returned.
+ */
+std::unique_ptr<Location> parse_any(std::string_view url, ParseResult &result);
+
+/*!
+ * Identify scheme of \p url and parse it into \p location in place.
+ *
+ * Like #StrBoUrl::Registry::parse_any(), but without heap allocation for
+ * the location object. On error, \p location is reset to
+ * \c std::monostate.
+ */
+ParseResult parse_any(std::string_view url, AnyLocation &location);
+
+}
+
+}
+
+#endif /* !STRBO_URL_REGISTRY_HH */
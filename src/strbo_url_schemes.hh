@@ -22,7 +22,8 @@
 #ifndef STRBO_URL_SCHEMES_HH
 #define STRBO_URL_SCHEMES_HH
 
-#include <string>
+#include <string_view>
+#include <cstring>
 
 namespace StrBoUrl
 {
@@ -37,40 +38,40 @@ namespace Schema
  * which are supposed to follow a scheme. It does not do much more than turning
  * a scheme name into a C++ type, thus providing type-safety, and defining a
  * function for checking whether or not a given URL matches the scheme.
+ *
+ * All scheme objects are meant to be \c constexpr. They refer to their names
+ * stored as string literals and have trivial destructors, so that they need
+ * neither static constructors nor initialization guards.
  */
 class StrBoLocator
 {
   private:
-    const std::string scheme_name_;
+    const std::string_view scheme_name_;
 
   protected:
-    explicit StrBoLocator(std::string &&scheme_name):
-        scheme_name_(std::move(scheme_name))
+    constexpr explicit StrBoLocator(std::string_view scheme_name):
+        scheme_name_(scheme_name)
     {}
 
   public:
     StrBoLocator(const StrBoLocator &) = delete;
     StrBoLocator &operator=(const StrBoLocator &) = delete;
 
-    virtual ~StrBoLocator() {}
-
-    const std::string &get_scheme_name() const { return scheme_name_; }
+    constexpr std::string_view get_scheme_name() const { return scheme_name_; }
 
-    bool url_matches_scheme(const std::string &url) const
+    bool url_matches_scheme(std::string_view url) const
     {
-        /* URL must be no shorter than the scheme name plus "://" */
-        if(url.length() < scheme_name_.length() + 3)
-            return false;
-
-        /* prefix must match the scheme name */
-        if(url.compare(0, scheme_name_.length(), scheme_name_) != 0)
-            return false;
+        const size_t len = scheme_name_.length();
 
-        /* scheme name must be followed by "://" separator */
-        if(url.compare(scheme_name_.length(), 3, "://") != 0)
+        /* URL must be no shorter than the scheme name plus "://" */
+        if(url.length() < len + 3)
             return false;
 
-        return true;
+        /* prefix must match the scheme name, followed by "://" separator;
+         * the length is a compile-time constant for the concrete schemes,
+         * so these turn into a few word comparisons */
+        return memcmp(url.data(), scheme_name_.data(), len) == 0 &&
+               memcmp(url.data() + len, "://", 3) == 0;
     }
 };
 
@@ -80,15 +81,13 @@ class StrBoLocator
 class ResourceLocatorSimple: public StrBoLocator
 {
   protected:
-    explicit ResourceLocatorSimple(std::string &&scheme_name):
-        StrBoLocator(std::move(scheme_name))
+    constexpr explicit ResourceLocatorSimple(std::string_view scheme_name):
+        StrBoLocator(scheme_name)
     {}
 
   public:
     ResourceLocatorSimple(const ResourceLocatorSimple &) = delete;
     ResourceLocatorSimple &operator=(const ResourceLocatorSimple &) = delete;
-
-    virtual ~ResourceLocatorSimple() {}
 };
 
 /*!
@@ -97,15 +96,13 @@ class ResourceLocatorSimple: public StrBoLocator
 class ResourceLocatorReference: public StrBoLocator
 {
   protected:
-    explicit ResourceLocatorReference(std::string &&scheme_name):
-        StrBoLocator(std::move(scheme_name))
+    constexpr explicit ResourceLocatorReference(std::string_view scheme_name):
+        StrBoLocator(scheme_name)
     {}
 
   public:
     ResourceLocatorReference(const ResourceLocatorReference &) = delete;
     ResourceLocatorReference &operator=(const ResourceLocatorReference &) = delete;
-
-    virtual ~ResourceLocatorReference() {}
 };
 
 /*!
@@ -114,15 +111,13 @@ class ResourceLocatorReference: public StrBoLocator
 class TraceLocator: public StrBoLocator
 {
   protected:
-    explicit TraceLocator(std::string &&scheme_name):
-        StrBoLocator(std::move(scheme_name))
+    constexpr explicit TraceLocator(std::string_view scheme_name):
+        StrBoLocator(scheme_name)
     {}
 
   public:
     TraceLocator(const TraceLocator &) = delete;
     TraceLocator &operator=(const TraceLocator &) = delete;
-
-    virtual ~TraceLocator() {}
 };
 
 }
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_table.hh"
+
+bool USB::LocationKeySimpleTable::append(const LocationKeySimple &l)
+{
+    if(!l.is_valid())
+        return false;
+
+    const auto &c(l.unpack());
+
+    if(!heap_has_room_for(c.device_.length() + c.partition_.length() + c.path_.length()))
+        return false;
+
+    push_field(DEVICE, c.device_);
+    push_field(PARTITION, c.partition_);
+    push_field(PATH, c.path_);
+
+    return true;
+}
+
+bool USB::LocationKeySimpleTable::append(const LocationKeySimpleView &view)
+{
+    if(!view.is_valid() || !heap_has_room_for(view.get_url().length()))
+        return false;
+
+    push_field(DEVICE, view, view.get_device());
+    push_field(PARTITION, view, view.get_partition());
+    push_field(PATH, view, view.get_path());
+
+    return true;
+}
+
+StrBoUrl::ParseResult USB::LocationKeySimpleTable::append_url(std::string_view url)
+{
+    LocationKeySimpleView view;
+    const auto result = view.try_set_url(url);
+
+    if(result.is_ok() && !append(view))
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::OUT_OF_RANGE,
+                                     StrBoUrl::ParseResult::Component::URL, 0);
+
+    return result;
+}
+
+void USB::LocationKeySimpleTable::get(size_t row, LocationKeySimple &l) const
+{
+    l.set_device(std::string(get_device(row)));
+    l.set_partition(std::string(get_partition(row)));
+    l.set_path(std::string(get_path(row)));
+}
+
+template <typename LocationT, typename ViewT>
+bool USB::ReferenceTable<LocationT, ViewT>::append(const LocationT &l)
+{
+    if(!l.is_valid())
+        return false;
+
+    const auto &c(l.unpack());
+
+    if(!heap_has_room_for(c.device_.length() + c.partition_.length() +
+                          c.reference_point_.length() + c.item_name_.length()))
+        return false;
+
+    push_field(DEVICE, c.device_);
+    push_field(PARTITION, c.partition_);
+    push_field(REFERENCE_POINT, c.reference_point_);
+    push_field(ITEM_NAME, c.item_name_);
+    item_positions_.push_back(c.item_position_.get_object_index());
+
+    return true;
+}
+
+template <typename LocationT, typename ViewT>
+bool USB::ReferenceTable<LocationT, ViewT>::append(const ViewT &view)
+{
+    if(!view.is_valid() || !heap_has_room_for(view.get_url().length()))
+        return false;
+
+    push_field(DEVICE, view, view.get_device());
+    push_field(PARTITION, view, view.get_partition());
+    push_field(REFERENCE_POINT, view, view.get_reference_point());
+    push_field(ITEM_NAME, view, view.get_item_name());
+    item_positions_.push_back(view.get_item_position().get_object_index());
+
+    return true;
+}
+
+template <typename LocationT, typename ViewT>
+StrBoUrl::ParseResult
+USB::ReferenceTable<LocationT, ViewT>::append_url(std::string_view url)
+{
+    ViewT view;
+    const auto result = view.try_set_url(url);
+
+    if(result.is_ok() && !append(view))
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::OUT_OF_RANGE,
+                                     StrBoUrl::ParseResult::Component::URL, 0);
+
+    return result;
+}
+
+template <typename LocationT, typename ViewT>
+void USB::ReferenceTable<LocationT, ViewT>::get(size_t row, LocationT &l) const
+{
+    l.set_device(std::string(get_device(row)));
+    l.set_partition(std::string(get_partition(row)));
+    l.set_reference_point(std::string(get_reference_point(row)));
+    l.set_item(std::string(get_item_name(row)), get_item_position(row));
+}
+
+template class USB::ReferenceTable<USB::LocationKeyReference, USB::LocationKeyReferenceView>;
+template class USB::ReferenceTable<USB::LocationTrace, USB::LocationTraceView>;
+
+bool Airable::LocationKeySimpleTable::append(const LocationKeySimple &l)
+{
+    if(!l.is_valid() || !heap_has_room_for(l.unpack().item_url_.length()))
+        return false;
+
+    push_field(ITEM, l.unpack().item_url_);
+
+    return true;
+}
+
+bool Airable::LocationKeySimpleTable::append(const LocationKeySimpleView &view)
+{
+    if(!view.is_valid() || !heap_has_room_for(view.get_url().length()))
+        return false;
+
+    push_field(ITEM, view, view.get_item());
+
+    return true;
+}
+
+StrBoUrl::ParseResult Airable::LocationKeySimpleTable::append_url(std::string_view url)
+{
+    LocationKeySimpleView view;
+    const auto result = view.try_set_url(url);
+
+    if(result.is_ok() && !append(view))
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::OUT_OF_RANGE,
+                                     StrBoUrl::ParseResult::Component::URL, 0);
+
+    return result;
+}
+
+void Airable::LocationKeySimpleTable::get(size_t row, LocationKeySimple &l) const
+{
+    l.set_item(std::string(get_item(row)));
+}
+
+bool Airable::LocationKeyReferenceTable::append(const LocationKeyReference &l)
+{
+    if(!l.is_valid())
+        return false;
+
+    const auto &c(l.unpack());
+
+    if(!heap_has_room_for(c.containing_list_url_.length() + c.item_url_.length()))
+        return false;
+
+    push_field(CONTAINING_LIST, c.containing_list_url_);
+    push_field(ITEM, c.item_url_);
+    item_positions_.push_back(c.item_position_.get_object_index());
+
+    return true;
+}
+
+bool Airable::LocationKeyReferenceTable::append(const LocationKeyReferenceView &view)
+{
+    if(!view.is_valid() || !heap_has_room_for(view.get_url().length()))
+        return false;
+
+    push_field(CONTAINING_LIST, view, view.get_containing_list());
+    push_field(ITEM, view, view.get_item());
+    item_positions_.push_back(view.get_item_position().get_object_index());
+
+    return true;
+}
+
+StrBoUrl::ParseResult Airable::LocationKeyReferenceTable::append_url(std::string_view url)
+{
+    LocationKeyReferenceView view;
+    const auto result = view.try_set_url(url);
+
+    if(result.is_ok() && !append(view))
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::OUT_OF_RANGE,
+                                     StrBoUrl::ParseResult::Component::URL, 0);
+
+    return result;
+}
+
+void Airable::LocationKeyReferenceTable::get(size_t row, LocationKeyReference &l) const
+{
+    l.set_containing_list(std::string(get_containing_list(row)));
+    l.set_item(std::string(get_item(row)), get_item_position(row));
+}
+
+void Airable::LocationTraceTable::clear()
+{
+    ColumnTable::clear();
+    item_positions_.clear();
+    first_level_.clear();
+    level_urls_.clear();
+    level_positions_.clear();
+}
+
+void Airable::LocationTraceTable::reserve(size_t rows, size_t levels, size_t heap_bytes)
+{
+    ColumnTable::reserve(rows, heap_bytes);
+    item_positions_.reserve(rows);
+    first_level_.reserve(rows);
+    level_urls_.reserve(levels);
+    level_positions_.reserve(levels);
+}
+
+size_t Airable::LocationTraceTable::get_memory_usage() const
+{
+    return ColumnTable::get_memory_usage() +
+           level_urls_.capacity() * sizeof(StrBoUrl::FieldRef) +
+           (item_positions_.capacity() + first_level_.capacity() +
+            level_positions_.capacity()) * sizeof(uint32_t);
+}
+
+bool Airable::LocationTraceTable::append(const LocationTrace &l)
+{
+    if(!l.is_valid())
+        return false;
+
+    const auto &c(l.unpack());
+    size_t bytes = c.reference_point_url_.length() + c.item_url_.length();
+
+    for(size_t i = 0; i < c.trace_urls_.size(); ++i)
+        bytes += c.trace_urls_.get_url(i).length();
+
+    if(!heap_has_room_for(bytes))
+        return false;
+
+    push_field(REFERENCE_POINT, c.reference_point_url_);
+    push_field(ITEM, c.item_url_);
+    item_positions_.push_back(c.item_position_.get_object_index());
+    first_level_.push_back(level_urls_.size());
+
+    for(size_t i = 0; i < c.trace_urls_.size(); ++i)
+    {
+        level_urls_.push_back(append_to_heap(c.trace_urls_.get_url(i)));
+        level_positions_.push_back(c.trace_urls_.get_position(i).get_object_index());
+    }
+
+    return true;
+}
+
+bool Airable::LocationTraceTable::append(const LocationTraceView &view)
+{
+    if(!view.is_valid() || !heap_has_room_for(view.get_url().length()))
+        return false;
+
+    push_field(REFERENCE_POINT, view, view.get_reference_point());
+    push_field(ITEM, view, view.get_item());
+    item_positions_.push_back(view.get_item_position().get_object_index());
+    first_level_.push_back(level_urls_.size());
+
+    view.for_each_trace_level(
+        [this, &view] (StrBoUrl::FieldRef url, StrBoUrl::ObjectIndex position)
+        {
+            const size_t begin = heap_.size();
+            view.decode(url,
+                        [this] (const char *data, size_t len) { heap_.append(data, len); });
+            level_urls_.push_back(StrBoUrl::FieldRef(begin, heap_.size()));
+            level_positions_.push_back(position.get_object_index());
+        });
+
+    return true;
+}
+
+StrBoUrl::ParseResult Airable::LocationTraceTable::append_url(std::string_view url)
+{
+    LocationTraceView view;
+    const auto result = view.try_set_url(url);
+
+    if(result.is_ok() && !append(view))
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::OUT_OF_RANGE,
+                                     StrBoUrl::ParseResult::Component::URL, 0);
+
+    return result;
+}
+
+void Airable::LocationTraceTable::get(size_t row, LocationTrace &l) const
+{
+    l.clear();
+    l.set_reference_point(std::string(get_reference_point(row)));
+
+    for(size_t i = 0; i < get_trace_length(row); ++i)
+        l.append_to_trace(std::string(get_trace_url(row, i)), get_trace_position(row, i));
+
+    l.set_item(std::string(get_item(row)), get_item_position(row));
+}
@@ -0,0 +1,437 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_TABLE_HH
+#define STRBO_URL_TABLE_HH
+
+#include "strbo_url_usb.hh"
+#include "strbo_url_airable.hh"
+
+#include <array>
+
+namespace StrBoUrl
+{
+
+/*!
+ * Base class for columnar storage of many locations of the same type.
+ *
+ * Decoded components of all rows are stored in a single string heap. For
+ * each of the \p N string components there is a column of positions in the
+ * heap. A component which is equal to the same component in the previous row
+ * is not stored again, so that runs of locations on the same device or in
+ * the same list cost only their column entries. Tables are meant for
+ * appending and reading; single rows cannot be modified.
+ *
+ * Positions are 32 bit wide, so the heap is limited to 4 GiB. Appending a
+ * row fails if it might not fit.
+ */
+template <size_t N>
+class ColumnTable
+{
+  protected:
+    std::string heap_;
+    std::array<std::vector<FieldRef>, N> columns_;
+
+    explicit ColumnTable() {}
+
+  public:
+    /*! Maximum size of the string heap. */
+    static constexpr size_t MAX_HEAP_SIZE = UINT32_MAX;
+
+    size_t size() const { return columns_[0].size(); }
+    bool empty() const { return columns_[0].empty(); }
+
+  protected:
+    /*
+     * The following functions cover only the members of this class. Derived
+     * classes with columns of their own make them public with their own
+     * implementations, or via using-declarations otherwise.
+     */
+    void clear()
+    {
+        heap_.clear();
+
+        for(auto &column : columns_)
+            column.clear();
+    }
+
+    void reserve(size_t rows, size_t heap_bytes)
+    {
+        heap_.reserve(heap_bytes);
+
+        for(auto &column : columns_)
+            column.reserve(rows);
+    }
+
+    /*!
+     * Number of bytes allocated by the table.
+     */
+    size_t get_memory_usage() const
+    {
+        size_t result = heap_.capacity();
+
+        for(const auto &column : columns_)
+            result += column.capacity() * sizeof(FieldRef);
+
+        return result;
+    }
+
+    /*!
+     * Whether or not \p bytes more bytes fit into the heap.
+     *
+     * To be checked before appending a row, with an upper bound of the
+     * length of all strings in the row. For views, the length of the URL
+     * is such a bound because decoding never makes strings longer.
+     */
+    bool heap_has_room_for(size_t bytes) const
+    {
+        return bytes <= MAX_HEAP_SIZE - heap_.size();
+    }
+
+    std::string_view get_string(FieldRef field) const
+    {
+        return std::string_view(heap_.data() + field.get_offset(), field.get_length());
+    }
+
+    std::string_view get_field(size_t row, size_t k) const
+    {
+        return get_string(columns_[k][row]);
+    }
+
+    /*!
+     * Store \p s, or reuse its copy if it equals the previous row's field.
+     */
+    void push_field(size_t k, std::string_view s)
+    {
+        auto &column(columns_[k]);
+
+        if(!column.empty() && get_string(column.back()) == s)
+            column.push_back(column.back());
+        else
+            column.push_back(append_to_heap(s));
+    }
+
+    void push_field(size_t k, const LocationView &view, FieldRef field)
+    {
+        const size_t begin = heap_.size();
+        view.decode(field,
+                    [this] (const char *data, size_t len) { heap_.append(data, len); });
+
+        auto &column(columns_[k]);
+        const FieldRef decoded(begin, heap_.size());
+
+        if(!column.empty() && get_string(column.back()) == get_string(decoded))
+        {
+            heap_.resize(begin);
+            column.push_back(column.back());
+        }
+        else
+            column.push_back(decoded);
+    }
+
+    FieldRef append_to_heap(std::string_view s)
+    {
+        const size_t begin = heap_.size();
+        heap_.append(s.data(), s.length());
+        return FieldRef(begin, heap_.size());
+    }
+};
+
+}
+
+namespace USB
+{
+
+/*!
+ * Columnar storage of simple USB location keys.
+ */
+class LocationKeySimpleTable: public ::StrBoUrl::ColumnTable<3>
+{
+  private:
+    enum Field { DEVICE, PARTITION, PATH };
+
+  public:
+    LocationKeySimpleTable(const LocationKeySimpleTable &) = delete;
+    LocationKeySimpleTable(LocationKeySimpleTable &&) = default;
+    LocationKeySimpleTable &operator=(const LocationKeySimpleTable &) = delete;
+    LocationKeySimpleTable &operator=(LocationKeySimpleTable &&) = default;
+
+    explicit LocationKeySimpleTable() {}
+
+    using ColumnTable::clear;
+    using ColumnTable::reserve;
+    using ColumnTable::get_memory_usage;
+
+    /*!
+     * Append location, returns \c false if \p l is invalid or if the table
+     * is full.
+     */
+    bool append(const LocationKeySimple &l);
+
+    /*!
+     * Append decoded components of view, returns \c false if \p view is
+     * invalid or if the table is full.
+     */
+    bool append(const LocationKeySimpleView &view);
+
+    /*!
+     * Parse URL and append it, nothing is appended in case of errors.
+     *
+     * A full table is reported as #StrBoUrl::ParseResult::Code::OUT_OF_RANGE.
+     */
+    StrBoUrl::ParseResult append_url(std::string_view url);
+
+    std::string_view get_device(size_t row) const { return get_field(row, DEVICE); }
+    std::string_view get_partition(size_t row) const { return get_field(row, PARTITION); }
+    std::string_view get_path(size_t row) const { return get_field(row, PATH); }
+
+    /*!
+     * Copy row into location object.
+     */
+    void get(size_t row, LocationKeySimple &l) const;
+};
+
+/*!
+ * Columnar storage of USB locations with reference point and item.
+ *
+ * Used for #USB::LocationKeyReference and #USB::LocationTrace, which have
+ * the same components.
+ */
+template <typename LocationT, typename ViewT>
+class ReferenceTable: public ::StrBoUrl::ColumnTable<4>
+{
+  private:
+    enum Field { DEVICE, PARTITION, REFERENCE_POINT, ITEM_NAME };
+
+    std::vector<uint32_t> item_positions_;
+
+  public:
+    ReferenceTable(const ReferenceTable &) = delete;
+    ReferenceTable(ReferenceTable &&) = default;
+    ReferenceTable &operator=(const ReferenceTable &) = delete;
+    ReferenceTable &operator=(ReferenceTable &&) = default;
+
+    explicit ReferenceTable() {}
+
+    void clear()
+    {
+        ColumnTable::clear();
+        item_positions_.clear();
+    }
+
+    void reserve(size_t rows, size_t heap_bytes)
+    {
+        ColumnTable::reserve(rows, heap_bytes);
+        item_positions_.reserve(rows);
+    }
+
+    size_t get_memory_usage() const
+    {
+        return ColumnTable::get_memory_usage() +
+               item_positions_.capacity() * sizeof(uint32_t);
+    }
+
+    bool append(const LocationT &l);
+    bool append(const ViewT &view);
+    StrBoUrl::ParseResult append_url(std::string_view url);
+
+    std::string_view get_device(size_t row) const { return get_field(row, DEVICE); }
+    std::string_view get_partition(size_t row) const { return get_field(row, PARTITION); }
+    std::string_view get_reference_point(size_t row) const { return get_field(row, REFERENCE_POINT); }
+    std::string_view get_item_name(size_t row) const { return get_field(row, ITEM_NAME); }
+
+    StrBoUrl::ObjectIndex get_item_position(size_t row) const
+    {
+        return StrBoUrl::ObjectIndex(item_positions_[row]);
+    }
+
+    /*!
+     * The packed column of item positions, for fast scans.
+     */
+    const std::vector<uint32_t> &get_item_positions() const { return item_positions_; }
+
+    void get(size_t row, LocationT &l) const;
+};
+
+using LocationKeyReferenceTable = ReferenceTable<LocationKeyReference, LocationKeyReferenceView>;
+using LocationTraceTable = ReferenceTable<LocationTrace, LocationTraceView>;
+
+}
+
+namespace Airable
+{
+
+/*!
+ * Columnar storage of simple Airable location keys.
+ */
+class LocationKeySimpleTable: public ::StrBoUrl::ColumnTable<1>
+{
+  private:
+    enum Field { ITEM };
+
+  public:
+    LocationKeySimpleTable(const LocationKeySimpleTable &) = delete;
+    LocationKeySimpleTable(LocationKeySimpleTable &&) = default;
+    LocationKeySimpleTable &operator=(const LocationKeySimpleTable &) = delete;
+    LocationKeySimpleTable &operator=(LocationKeySimpleTable &&) = default;
+
+    explicit LocationKeySimpleTable() {}
+
+    using ColumnTable::clear;
+    using ColumnTable::reserve;
+    using ColumnTable::get_memory_usage;
+
+    bool append(const LocationKeySimple &l);
+    bool append(const LocationKeySimpleView &view);
+    StrBoUrl::ParseResult append_url(std::string_view url);
+
+    std::string_view get_item(size_t row) const { return get_field(row, ITEM); }
+
+    void get(size_t row, LocationKeySimple &l) const;
+};
+
+/*!
+ * Columnar storage of Airable reference location keys.
+ */
+class LocationKeyReferenceTable: public ::StrBoUrl::ColumnTable<2>
+{
+  private:
+    enum Field { CONTAINING_LIST, ITEM };
+
+    std::vector<uint32_t> item_positions_;
+
+  public:
+    LocationKeyReferenceTable(const LocationKeyReferenceTable &) = delete;
+    LocationKeyReferenceTable(LocationKeyReferenceTable &&) = default;
+    LocationKeyReferenceTable &operator=(const LocationKeyReferenceTable &) = delete;
+    LocationKeyReferenceTable &operator=(LocationKeyReferenceTable &&) = default;
+
+    explicit LocationKeyReferenceTable() {}
+
+    void clear()
+    {
+        ColumnTable::clear();
+        item_positions_.clear();
+    }
+
+    void reserve(size_t rows, size_t heap_bytes)
+    {
+        ColumnTable::reserve(rows, heap_bytes);
+        item_positions_.reserve(rows);
+    }
+
+    size_t get_memory_usage() const
+    {
+        return ColumnTable::get_memory_usage() +
+               item_positions_.capacity() * sizeof(uint32_t);
+    }
+
+    bool append(const LocationKeyReference &l);
+    bool append(const LocationKeyReferenceView &view);
+    StrBoUrl::ParseResult append_url(std::string_view url);
+
+    std::string_view get_containing_list(size_t row) const { return get_field(row, CONTAINING_LIST); }
+    std::string_view get_item(size_t row) const { return get_field(row, ITEM); }
+
+    StrBoUrl::ObjectIndex get_item_position(size_t row) const
+    {
+        return StrBoUrl::ObjectIndex(item_positions_[row]);
+    }
+
+    const std::vector<uint32_t> &get_item_positions() const { return item_positions_; }
+
+    void get(size_t row, LocationKeyReference &l) const;
+};
+
+/*!
+ * Columnar storage of Airable location traces.
+ *
+ * The trace levels of all rows are stored in columns of their own, with
+ * the level URLs in the common string heap.
+ */
+class LocationTraceTable: public ::StrBoUrl::ColumnTable<2>
+{
+  private:
+    enum Field { REFERENCE_POINT, ITEM };
+
+    std::vector<uint32_t> item_positions_;
+
+    /* per row: index of first trace level in the level columns */
+    std::vector<uint32_t> first_level_;
+
+    /* per trace level: URL in heap and position */
+    std::vector<StrBoUrl::FieldRef> level_urls_;
+    std::vector<uint32_t> level_positions_;
+
+  public:
+    LocationTraceTable(const LocationTraceTable &) = delete;
+    LocationTraceTable(LocationTraceTable &&) = default;
+    LocationTraceTable &operator=(const LocationTraceTable &) = delete;
+    LocationTraceTable &operator=(LocationTraceTable &&) = default;
+
+    explicit LocationTraceTable() {}
+
+    void clear();
+    void reserve(size_t rows, size_t levels, size_t heap_bytes);
+    size_t get_memory_usage() const;
+
+    bool append(const LocationTrace &l);
+    bool append(const LocationTraceView &view);
+    StrBoUrl::ParseResult append_url(std::string_view url);
+
+    std::string_view get_reference_point(size_t row) const { return get_field(row, REFERENCE_POINT); }
+
+    std::string_view get_item(size_t row) const { return get_field(row, ITEM); }
+
+    StrBoUrl::ObjectIndex get_item_position(size_t row) const
+    {
+        return StrBoUrl::ObjectIndex(item_positions_[row]);
+    }
+
+    const std::vector<uint32_t> &get_item_positions() const { return item_positions_; }
+
+    size_t get_trace_length(size_t row) const
+    {
+        return levels_end(row) - first_level_[row];
+    }
+
+    std::string_view get_trace_url(size_t row, size_t level) const
+    {
+        return get_string(level_urls_[first_level_[row] + level]);
+    }
+
+    StrBoUrl::ObjectIndex get_trace_position(size_t row, size_t level) const
+    {
+        return StrBoUrl::ObjectIndex(level_positions_[first_level_[row] + level]);
+    }
+
+    void get(size_t row, LocationTrace &l) const;
+
+  private:
+    size_t levels_end(size_t row) const
+    {
+        return row + 1 < size() ? first_level_[row + 1] : level_urls_.size();
+    }
+};
+
+}
+
+#endif /* !STRBO_URL_TABLE_HH */
@@ -26,201 +26,306 @@
 #include "strbo_url_usb.hh"
 #include "strbo_url_helpers.hh"
 
-#include <sstream>
 #include <algorithm>
 
-std::string USB::LocationKeySimple::str_impl() const
+template <typename StringT>
+static void decode_component(const StrBoUrl::LocationView &view,
+                             StrBoUrl::FieldRef field, StringT &dest)
 {
-    std::string result = scheme_.get_scheme_name() + "://";
-
-    StrBoUrl::for_each_url_encoded(c_.device_,
-        [&result] (const char *enc, size_t len) { result.append(enc, len); });
+    view.decode(field, dest);
+}
 
-    result += ':';
+static void decode_component(const StrBoUrl::LocationView &view,
+                             StrBoUrl::FieldRef field, StrBoUrl::InternedString &dest)
+{
+    dest = StrBoUrl::InternedString::from_encoded(view.raw(field));
+}
 
-    StrBoUrl::for_each_url_encoded(c_.partition_,
-        [&result] (const char *enc, size_t len) { result.append(enc, len); });
+template <typename SinkFn, typename StringT>
+static void serialize(SinkFn &sink, const StrBoUrl::Schema::StrBoLocator &scheme,
+                      const USB::BasicLocationKeySimple<StringT> &l)
+{
+    const auto &c(l.unpack());
+
+    StrBoUrl::Serialize::scheme(sink, scheme);
+    StrBoUrl::Serialize::encoded(sink, c.device_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::encoded(sink, c.partition_);
+    StrBoUrl::Serialize::character(sink, '/');
+    StrBoUrl::Serialize::encoded(sink, c.path_);
+}
 
-    result += '/';
+template <typename StringT>
+size_t USB::BasicLocationKeySimple<StringT>::encoded_length_impl() const
+{
+    StrBoUrl::Serialize::LengthSink sink;
+    serialize(sink, *scheme_, *this);
+    return sink.get_length();
+}
 
-    StrBoUrl::for_each_url_encoded(c_.path_,
-        [&result] (const char *enc, size_t len) { result.append(enc, len); });
+template <typename StringT>
+void USB::BasicLocationKeySimple<StringT>::write_impl(char *out) const
+{
+    StrBoUrl::Serialize::BufferSink sink(out);
+    serialize(sink, *scheme_, *this);
+}
 
-    return result;
+template <typename StringT>
+void USB::BasicLocationKeySimple<StringT>::serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const
+{
+    serialize(sink, *scheme_, *this);
 }
 
-const char *USB::LocationKeySimple::get_error_prefix()
+template <typename StringT>
+const char *USB::BasicLocationKeySimple<StringT>::get_error_prefix()
 {
     return "Simple USB location key malformed: ";
 }
 
-const char *USB::LocationKeySimple::set_url_impl(const std::string &url, size_t offset)
+StrBoUrl::ParseResult USB::LocationKeySimpleView::try_set_url(std::string_view url) noexcept
+{
+    return StrBoUrl::Parse::parse_view(*this, url, LocationKeySimple::get_scheme());
+}
+
+StrBoUrl::ParseResult
+USB::LocationKeySimpleView::parse_fields(std::string_view url, size_t offset,
+                                         const StrBoUrl::Parse::StructuralIndex &index) noexcept
 {
+    using Component = StrBoUrl::ParseResult::Component;
+    StrBoUrl::Parse::ErrorCollector errors(url.data());
+
     const auto end_of_device = StrBoUrl::Parse::extract_field(
-        url, offset, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Device", error_message);
-        });
+        index, offset, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::DEVICE));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto end_of_partition = StrBoUrl::Parse::extract_field(
-        url, offset, '/', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Partition", error_message);
-        });
+        index, offset, '/', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::PARTITION));
 
-    if(end_of_partition <= end_of_device)
-        throw ParsingError(get_error_prefix(), nullptr,
-                           "Failed parsing device and partition");
-
-    c_.device_.clear();
-    c_.partition_.clear();
-    c_.path_.clear();
-
-    StrBoUrl::for_each_url_decoded(url.substr(offset, end_of_device - offset),
-        [this] (const char ch) { c_.device_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Device", e.c_str()); });
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_device + 1,
-                                              end_of_partition - end_of_device - 1),
-        [this] (const char ch) { c_.partition_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Partition", e.c_str()); });
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_partition + 1),
-        [this] (const char ch) { c_.path_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Item name", e.c_str()); });
+    if(errors.failed())
+        return errors.get_result();
 
-    is_partition_set_ = true;
-    is_path_set_ = true;
-    return nullptr;
+    if(end_of_partition <= end_of_device)
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::BAD_DEVICE_OR_PARTITION,
+                                     Component::URL, offset);
+
+    if(!StrBoUrl::Parse::check_encoding(index, offset, end_of_device,
+                                        errors.in(Component::DEVICE)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_device + 1, end_of_partition,
+                                        errors.in(Component::PARTITION)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_partition + 1, url.length(),
+                                        errors.in(Component::ITEM_NAME)))
+        return errors.get_result();
+
+    set_url_buffer(url);
+    device_ = StrBoUrl::FieldRef(offset, end_of_device);
+    partition_ = StrBoUrl::FieldRef(end_of_device + 1, end_of_partition);
+    path_ = StrBoUrl::FieldRef(end_of_partition + 1, url.length());
+
+    return StrBoUrl::ParseResult();
 }
 
-std::string USB::LocationKeyReference::str_impl() const
+template <typename StringT>
+void USB::BasicLocationKeySimple<StringT>::set_from_view(const LocationKeySimpleView &view)
 {
-    std::ostringstream os;
-    os << scheme_.get_scheme_name() << "://";
+    invalidate_str();
 
-    StrBoUrl::for_each_url_encoded(c_.device_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+    if(!view.is_valid())
+    {
+        clear();
+        return;
+    }
 
-    os << ':';
+    decode_component(view, view.get_device(), c_.device_);
+    decode_component(view, view.get_partition(), c_.partition_);
+    view.decode(view.get_path(), c_.path_);
+    is_partition_set_ = true;
+    is_path_set_ = true;
+}
 
-    StrBoUrl::for_each_url_encoded(c_.partition_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+template <typename StringT>
+StrBoUrl::ParseResult
+USB::BasicLocationKeySimple<StringT>::try_set_url_impl(std::string_view url, size_t offset,
+                                                       const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    LocationKeySimpleView view;
+    const auto result = view.parse_fields(url, offset, index);
 
-    os << '/';
+    if(result.is_ok())
+        set_from_view(view);
 
-    StrBoUrl::for_each_url_encoded(c_.reference_point_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+    return result;
+}
 
-    os << '/';
+template <typename SinkFn, typename StringT>
+static void serialize(SinkFn &sink, const StrBoUrl::Schema::StrBoLocator &scheme,
+                      const USB::BasicLocationKeyReference<StringT> &l)
+{
+    const auto &c(l.unpack());
+
+    StrBoUrl::Serialize::scheme(sink, scheme);
+    StrBoUrl::Serialize::encoded(sink, c.device_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::encoded(sink, c.partition_);
+    StrBoUrl::Serialize::character(sink, '/');
+    StrBoUrl::Serialize::encoded(sink, c.reference_point_);
+    StrBoUrl::Serialize::character(sink, '/');
+    StrBoUrl::Serialize::encoded(sink, c.item_name_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::position(sink, c.item_position_);
+}
 
-    StrBoUrl::for_each_url_encoded(c_.item_name_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+template <typename StringT>
+size_t USB::BasicLocationKeyReference<StringT>::encoded_length_impl() const
+{
+    StrBoUrl::Serialize::LengthSink sink;
+    serialize(sink, *scheme_, *this);
+    return sink.get_length();
+}
 
-    os << ':' << c_.item_position_.get_object_index();
+template <typename StringT>
+void USB::BasicLocationKeyReference<StringT>::write_impl(char *out) const
+{
+    StrBoUrl::Serialize::BufferSink sink(out);
+    serialize(sink, *scheme_, *this);
+}
 
-    return os.str();
+template <typename StringT>
+void USB::BasicLocationKeyReference<StringT>::serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const
+{
+    serialize(sink, *scheme_, *this);
 }
 
-const char *USB::LocationKeyReference::get_error_prefix()
+template <typename StringT>
+const char *USB::BasicLocationKeyReference<StringT>::get_error_prefix()
 {
     return "Reference USB location key malformed: ";
 }
 
-const char *USB::LocationKeyReference::set_url_impl(const std::string &url, size_t offset)
+StrBoUrl::ParseResult USB::LocationKeyReferenceView::try_set_url(std::string_view url) noexcept
+{
+    return StrBoUrl::Parse::parse_view(*this, url, LocationKeyReference::get_scheme());
+}
+
+StrBoUrl::ParseResult
+USB::LocationKeyReferenceView::parse_fields(std::string_view url, size_t offset,
+                                            const StrBoUrl::Parse::StructuralIndex &index) noexcept
 {
+    using Component = StrBoUrl::ParseResult::Component;
+    StrBoUrl::Parse::ErrorCollector errors(url.data());
+
     const auto end_of_device = StrBoUrl::Parse::extract_field(
-        url, offset, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Device", error_message);
-        });
+        index, offset, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::DEVICE));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto end_of_partition = StrBoUrl::Parse::extract_field(
-        url, offset, '/', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Partition", error_message);
-        });
+        index, offset, '/', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::PARTITION));
+
+    if(errors.failed())
+        return errors.get_result();
 
     if(end_of_partition <= end_of_device)
-        throw ParsingError(get_error_prefix(), nullptr,
-                           "Failed parsing device and partition");
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::BAD_DEVICE_OR_PARTITION,
+                                     Component::URL, offset);
 
     const auto end_of_reference = StrBoUrl::Parse::extract_field(
-        url, end_of_partition + 1, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Reference point", error_message);
-        });
+        index, end_of_partition + 1, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
+        errors.in(Component::REFERENCE_POINT));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const bool is_reference_empty = end_of_reference == end_of_partition + 1;
 
     const auto end_of_item = StrBoUrl::Parse::extract_field(
-        url, end_of_reference + 1, ':',
+        index, end_of_reference + 1, ':',
         is_reference_empty
         ? StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY
         : StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item name", error_message);
-        });
+        errors.in(Component::ITEM_NAME));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto item_position = StrBoUrl::Parse::item_position(
-        url, end_of_item + 1,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item position", error_message);
-        });
-
-    std::string temp;
-    bool is_path = false;
-
-    StrBoUrl::for_each_url_decoded(
-        url.substr(end_of_reference + 1, end_of_item - end_of_reference - 1),
-        [&temp, &is_path] (const char ch)
-        {
-            temp += ch;
-
-            if(ch == '/')
-                is_path = true;
-        },
-        [] (std::string &&e) { throw ParsingError(get_error_prefix(), "Item component", e.c_str()); });
-
-    if(is_path)
-        throw ParsingError(get_error_prefix(), "Item component", "Component is a path");
-
-    c_.device_.clear();
-    c_.partition_.clear();
-    c_.reference_point_.clear();
-    c_.item_name_ = std::move(temp);
-    c_.item_position_ = item_position;
-
-    StrBoUrl::for_each_url_decoded(url.substr(offset, end_of_device - offset),
-        [this] (const char ch) { c_.device_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Device", e.c_str()); });
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_device + 1,
-                                              end_of_partition - end_of_device - 1),
-        [this] (const char ch) { c_.partition_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Partition", e.c_str()); });
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_partition + 1,
-                                              end_of_reference - end_of_partition - 1),
-        [this] (const char ch) { c_.reference_point_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Reference point", e.c_str()); });
+        url, end_of_item + 1, errors.in(Component::ITEM_POSITION));
+
+    if(errors.failed())
+        return errors.get_result();
+
+    if(!StrBoUrl::Parse::check_encoding(index, end_of_reference + 1, end_of_item,
+                                        errors.in(Component::ITEM_COMPONENT)))
+        return errors.get_result();
+
+    const auto item = url.substr(end_of_reference + 1, end_of_item - end_of_reference - 1);
+
+    if(item.find('/') != std::string_view::npos ||
+       StrBoUrl::Parse::contains_encoded_slash(item))
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::COMPONENT_IS_PATH,
+                                     Component::ITEM_COMPONENT, end_of_reference + 1);
+
+    if(!StrBoUrl::Parse::check_encoding(index, offset, end_of_device,
+                                        errors.in(Component::DEVICE)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_device + 1, end_of_partition,
+                                        errors.in(Component::PARTITION)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_partition + 1, end_of_reference,
+                                        errors.in(Component::REFERENCE_POINT)))
+        return errors.get_result();
+
+    set_url_buffer(url);
+    device_ = StrBoUrl::FieldRef(offset, end_of_device);
+    partition_ = StrBoUrl::FieldRef(end_of_device + 1, end_of_partition);
+    reference_point_ = StrBoUrl::FieldRef(end_of_partition + 1, end_of_reference);
+    item_name_ = StrBoUrl::FieldRef(end_of_reference + 1, end_of_item);
+    item_position_ = item_position;
+
+    return StrBoUrl::ParseResult();
+}
+
+template <typename StringT>
+void USB::BasicLocationKeyReference<StringT>::set_from_view(const LocationKeyReferenceView &view)
+{
+    invalidate_str();
+
+    if(!view.is_valid())
+    {
+        clear();
+        return;
+    }
 
+    decode_component(view, view.get_device(), c_.device_);
+    decode_component(view, view.get_partition(), c_.partition_);
+    view.decode(view.get_reference_point(), c_.reference_point_);
+    view.decode(view.get_item_name(), c_.item_name_);
+    c_.item_position_ = view.get_item_position();
     is_partition_set_ = true;
     is_reference_point_set_ = true;
     is_item_set_ = true;
-    return nullptr;
 }
 
-size_t USB::LocationTrace::get_trace_length() const
+template <typename StringT>
+StrBoUrl::ParseResult
+USB::BasicLocationKeyReference<StringT>::try_set_url_impl(std::string_view url, size_t offset,
+                                                          const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    LocationKeyReferenceView view;
+    const auto result = view.parse_fields(url, offset, index);
+
+    if(result.is_ok())
+        set_from_view(view);
+
+    return result;
+}
+
+template <typename StringT>
+size_t USB::BasicLocationTrace<StringT>::get_trace_length() const
 {
 
     if(c_.item_name_.empty())
@@ -230,131 +335,185 @@ size_t USB::LocationTrace::get_trace_length() const
                              [] (const char &ch) { return ch == '/'; });
 }
 
-std::string USB::LocationTrace::str_impl() const
+template <typename SinkFn, typename StringT>
+static void serialize(SinkFn &sink, const StrBoUrl::Schema::StrBoLocator &scheme,
+                      const USB::BasicLocationTrace<StringT> &l)
 {
-    std::ostringstream os;
-    os << scheme_.get_scheme_name() << "://";
-
-    StrBoUrl::for_each_url_encoded(c_.device_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
-
-    os << ':';
+    const auto &c(l.unpack());
 
-    StrBoUrl::for_each_url_encoded(c_.partition_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+    StrBoUrl::Serialize::scheme(sink, scheme);
+    StrBoUrl::Serialize::encoded(sink, c.device_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::encoded(sink, c.partition_);
+    StrBoUrl::Serialize::character(sink, '/');
 
-    os << '/';
-
-    if(!c_.reference_point_.empty())
+    if(!c.reference_point_.empty())
     {
-        StrBoUrl::for_each_url_encoded(c_.reference_point_,
-            [&os] (const char *enc, size_t len) { os.write(enc, len); });
-
-        os << '/';
+        StrBoUrl::Serialize::encoded(sink, c.reference_point_);
+        StrBoUrl::Serialize::character(sink, '/');
     }
 
-    StrBoUrl::for_each_url_encoded(c_.item_name_,
-        [&os] (const char *enc, size_t len) { os.write(enc, len); });
+    StrBoUrl::Serialize::encoded(sink, c.item_name_);
+    StrBoUrl::Serialize::character(sink, ':');
+    StrBoUrl::Serialize::position(sink, c.item_position_);
+}
 
-    os << ':' << c_.item_position_.get_object_index();
+template <typename StringT>
+size_t USB::BasicLocationTrace<StringT>::encoded_length_impl() const
+{
+    StrBoUrl::Serialize::LengthSink sink;
+    serialize(sink, *scheme_, *this);
+    return sink.get_length();
+}
+
+template <typename StringT>
+void USB::BasicLocationTrace<StringT>::write_impl(char *out) const
+{
+    StrBoUrl::Serialize::BufferSink sink(out);
+    serialize(sink, *scheme_, *this);
+}
 
-    return os.str();
+template <typename StringT>
+void USB::BasicLocationTrace<StringT>::serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const
+{
+    serialize(sink, *scheme_, *this);
 }
 
-const char *USB::LocationTrace::get_error_prefix()
+template <typename StringT>
+const char *USB::BasicLocationTrace<StringT>::get_error_prefix()
 {
     return "USB location trace malformed: ";
 }
 
-const char *USB::LocationTrace::set_url_impl(const std::string &url, size_t offset)
+StrBoUrl::ParseResult USB::LocationTraceView::try_set_url(std::string_view url) noexcept
+{
+    return StrBoUrl::Parse::parse_view(*this, url, LocationTrace::get_scheme());
+}
+
+StrBoUrl::ParseResult
+USB::LocationTraceView::parse_fields(std::string_view url, size_t offset,
+                                     const StrBoUrl::Parse::StructuralIndex &index) noexcept
 {
+    using Component = StrBoUrl::ParseResult::Component;
+    StrBoUrl::Parse::ErrorCollector errors(url.data());
+
     const auto end_of_device = StrBoUrl::Parse::extract_field(
-        url, offset, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Device", error_message);
-        });
+        index, offset, ':', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::DEVICE));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto end_of_partition = StrBoUrl::Parse::extract_field(
-        url, offset, '/', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Partition", error_message);
-        });
+        index, offset, '/', StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
+        errors.in(Component::PARTITION));
+
+    if(errors.failed())
+        return errors.get_result();
 
     if(end_of_partition <= end_of_device)
-        throw ParsingError(get_error_prefix(), nullptr,
-                           "Failed parsing device and partition");
+        return StrBoUrl::ParseResult(StrBoUrl::ParseResult::Code::BAD_DEVICE_OR_PARTITION,
+                                     Component::URL, offset);
 
     const auto end_of_reference =
-        url.find('/', end_of_partition + 1) != std::string::npos
+        index.find('/', end_of_partition + 1) != StrBoUrl::Parse::StructuralIndex::npos
         ? StrBoUrl::Parse::extract_field(
-            url, end_of_partition + 1, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
-            [] (const char *error_message)
-            {
-                throw ParsingError(get_error_prefix(), "Reference point", error_message);
-            })
+            index, end_of_partition + 1, '/', StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY,
+            errors.in(Component::REFERENCE_POINT))
         : end_of_partition;
 
+    if(errors.failed())
+        return errors.get_result();
+
     const bool is_reference_empty = end_of_reference == end_of_partition;
 
     const auto end_of_item = StrBoUrl::Parse::extract_field(
-        url, end_of_reference + 1, ':',
+        index, end_of_reference + 1, ':',
         is_reference_empty
         ? StrBoUrl::Parse::FieldPolicy::MAY_BE_EMPTY
         : StrBoUrl::Parse::FieldPolicy::MUST_NOT_BE_EMPTY,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item name", error_message);
-        });
+        errors.in(Component::ITEM_NAME));
+
+    if(errors.failed())
+        return errors.get_result();
 
     const auto item_position = StrBoUrl::Parse::item_position(
-        url, end_of_item + 1,
-        [] (const char *error_message)
-        {
-            throw ParsingError(get_error_prefix(), "Item position", error_message);
-        });
-
-    c_.device_.clear();
-    c_.partition_.clear();
-    c_.reference_point_.clear();
-    c_.item_name_.clear();
-    c_.item_position_ = item_position;
-
-    StrBoUrl::for_each_url_decoded(url.substr(offset, end_of_device - offset),
-        [this] (const char ch) { c_.device_ += ch; } ,
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Device", e.c_str()); });
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_device + 1,
-                                              end_of_partition - end_of_device - 1),
-        [this] (const char ch) { c_.partition_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Partition", e.c_str()); });
-
-    if(end_of_partition < end_of_reference)
-        StrBoUrl::for_each_url_decoded(url.substr(end_of_partition + 1,
-                                                  end_of_reference - end_of_partition - 1),
-            [this] (const char ch) { c_.reference_point_ += ch; },
-            [] (auto &&e)
-            { throw ParsingError(get_error_prefix(), "Reference point", e.c_str()); });
-
-    StrBoUrl::for_each_url_decoded(url.substr(end_of_reference + 1,
-                                              end_of_item - end_of_reference - 1),
-        [this] (const char ch) { c_.item_name_ += ch; },
-        [] (auto &&e)
-        { throw ParsingError(get_error_prefix(), "Item name", e.c_str()); });
-
-    const char *result;
-
-    if(c_.reference_point_ == "/")
+        url, end_of_item + 1, errors.in(Component::ITEM_POSITION));
+
+    if(errors.failed())
+        return errors.get_result();
+
+    if(!StrBoUrl::Parse::check_encoding(index, offset, end_of_device,
+                                        errors.in(Component::DEVICE)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_device + 1, end_of_partition,
+                                        errors.in(Component::PARTITION)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_partition + 1, end_of_reference,
+                                        errors.in(Component::REFERENCE_POINT)) ||
+       !StrBoUrl::Parse::check_encoding(index, end_of_reference + 1, end_of_item,
+                                        errors.in(Component::ITEM_NAME)))
+        return errors.get_result();
+
+    set_url_buffer(url);
+    device_ = StrBoUrl::FieldRef(offset, end_of_device);
+    partition_ = StrBoUrl::FieldRef(end_of_device + 1, end_of_partition);
+    reference_point_ = StrBoUrl::FieldRef(end_of_partition + 1, end_of_reference);
+    item_name_ = StrBoUrl::FieldRef(end_of_reference + 1, end_of_item);
+    item_position_ = item_position;
+
+    if(StrBoUrl::Parse::is_encoded_root(raw(reference_point_)))
+    {
+        reference_point_ = StrBoUrl::FieldRef();
+        return StrBoUrl::ParseResult("USB location trace contains unneeded explicit reference to root");
+    }
+
+    return StrBoUrl::ParseResult();
+}
+
+template <typename StringT>
+void USB::BasicLocationTrace<StringT>::set_from_view(const LocationTraceView &view)
+{
+    invalidate_str();
+
+    if(!view.is_valid())
     {
-        result = "USB location trace contains unneeded explicit reference to root";
-        c_.reference_point_.clear();
+        clear();
+        return;
     }
-    else
-        result = nullptr;
 
+    decode_component(view, view.get_device(), c_.device_);
+    decode_component(view, view.get_partition(), c_.partition_);
+    view.decode(view.get_reference_point(), c_.reference_point_);
+    view.decode(view.get_item_name(), c_.item_name_);
+    c_.item_position_ = view.get_item_position();
     is_partition_set_ = true;
     is_item_set_ = true;
+}
+
+template <typename StringT>
+StrBoUrl::ParseResult
+USB::BasicLocationTrace<StringT>::try_set_url_impl(std::string_view url, size_t offset,
+                                                   const StrBoUrl::Parse::StructuralIndex &index) noexcept
+{
+    LocationTraceView view;
+    const auto result = view.parse_fields(url, offset, index);
+
+    if(result.is_ok())
+        set_from_view(view);
+
     return result;
 }
+
+template class USB::BasicLocationKeySimple<std::string>;
+template class USB::BasicLocationKeySimple<std::pmr::string>;
+template class USB::BasicLocationKeyReference<std::string>;
+template class USB::BasicLocationKeyReference<std::pmr::string>;
+template class USB::BasicLocationTrace<std::string>;
+template class USB::BasicLocationTrace<std::pmr::string>;
+
+/* containers of locations rely on this for relocating their elements */
+static_assert(std::is_nothrow_move_constructible_v<USB::BasicLocationKeySimple<std::string>>);
+static_assert(std::is_nothrow_move_constructible_v<USB::BasicLocationKeySimple<std::pmr::string>>);
+static_assert(std::is_nothrow_move_constructible_v<USB::BasicLocationKeyReference<std::string>>);
+static_assert(std::is_nothrow_move_constructible_v<USB::BasicLocationKeyReference<std::pmr::string>>);
+static_assert(std::is_nothrow_move_constructible_v<USB::BasicLocationTrace<std::string>>);
+static_assert(std::is_nothrow_move_constructible_v<USB::BasicLocationTrace<std::pmr::string>>);
@@ -22,7 +22,11 @@
 #ifndef STRBO_URL_USB_HH
 #define STRBO_URL_USB_HH
 
-#include "strbo_url.hh"
+#include "strbo_url_view.hh"
+#include "strbo_url_intern.hh"
+
+#include <memory_resource>
+#include <vector>
 
 namespace USB
 {
@@ -33,7 +37,7 @@ namespace USB
 class ResourceLocatorSimple: public ::StrBoUrl::Schema::ResourceLocatorSimple
 {
   public:
-    explicit ResourceLocatorSimple():
+    constexpr explicit ResourceLocatorSimple():
         StrBoUrl::Schema::ResourceLocatorSimple("strbo-usb")
     {}
 };
@@ -44,7 +48,7 @@ class ResourceLocatorSimple: public ::StrBoUrl::Schema::ResourceLocatorSimple
 class ResourceLocatorReference: public ::StrBoUrl::Schema::ResourceLocatorReference
 {
   public:
-    explicit ResourceLocatorReference():
+    constexpr explicit ResourceLocatorReference():
         StrBoUrl::Schema::ResourceLocatorReference("strbo-ref-usb")
     {}
 };
@@ -55,25 +59,65 @@ class ResourceLocatorReference: public ::StrBoUrl::Schema::ResourceLocatorRefere
 class TraceLocator: public ::StrBoUrl::Schema::TraceLocator
 {
   public:
-    explicit TraceLocator():
+    constexpr explicit TraceLocator():
         StrBoUrl::Schema::TraceLocator("strbo-trace-usb")
     {}
 };
 
+/*!
+ * Non-owning view of a USB simple location key.
+ */
+class LocationKeySimpleView: public ::StrBoUrl::LocationView
+{
+  private:
+    StrBoUrl::FieldRef device_;
+    StrBoUrl::FieldRef partition_;
+    StrBoUrl::FieldRef path_;
+
+  public:
+    explicit LocationKeySimpleView() {}
+
+    void clear() { *this = LocationKeySimpleView(); }
+
+    /*!
+     * Set view from URL in caller-owned buffer.
+     *
+     * See #StrBoUrl::Location::try_set_url().
+     */
+    StrBoUrl::ParseResult try_set_url(std::string_view url) noexcept;
+
+    StrBoUrl::FieldRef get_device() const { return device_; }
+    StrBoUrl::FieldRef get_partition() const { return partition_; }
+    StrBoUrl::FieldRef get_path() const { return path_; }
+
+    StrBoUrl::ParseResult
+    parse_fields(std::string_view url, size_t offset,
+                 const StrBoUrl::Parse::StructuralIndex &index) noexcept;
+};
+
 /*!
  * Representation of a USB simple location key.
  */
-class LocationKeySimple: public ::StrBoUrl::Location
+template <typename StringT>
+class BasicLocationKeySimple: public ::StrBoUrl::Location
 {
   public:
+    using allocator_type = typename StringT::allocator_type;
+
     struct Components
     {
-        std::string device_;
-        std::string partition_;
-        std::string path_;
+        StrBoUrl::InternedStringFor<StringT> device_;
+        StrBoUrl::InternedStringFor<StringT> partition_;
+        StringT path_;
 
         Components() {}
 
+        explicit Components(const allocator_type &alloc):
+            device_(alloc),
+            partition_(alloc),
+            path_(alloc)
+        {}
+
         explicit Components(const char *device, const char *partition,
                             const char *path):
             device_(device),
@@ -84,21 +128,42 @@ class LocationKeySimple: public ::StrBoUrl::Location
 
   private:
     Components c_;
+    mutable ::StrBoUrl::MemoizedStr<StringT> str_memo_;
     bool is_partition_set_;
     bool is_path_set_;
 
   public:
-    LocationKeySimple(const LocationKeySimple &) = delete;
-    LocationKeySimple &operator=(const LocationKeySimple &) = delete;
+    BasicLocationKeySimple(const BasicLocationKeySimple &) = default;
+    BasicLocationKeySimple(BasicLocationKeySimple &&) = default;
+    BasicLocationKeySimple &operator=(const BasicLocationKeySimple &) = default;
+    BasicLocationKeySimple &operator=(BasicLocationKeySimple &&) = default;
 
-    explicit LocationKeySimple():
+    explicit BasicLocationKeySimple():
         ::StrBoUrl::Location(get_scheme()),
         is_partition_set_(false),
         is_path_set_(false)
     {}
 
+    /*!
+     * Construct empty location whose components use \p alloc.
+     */
+    explicit BasicLocationKeySimple(const allocator_type &alloc):
+        ::StrBoUrl::Location(get_scheme()),
+        c_(alloc),
+        str_memo_(alloc),
+        is_partition_set_(false),
+        is_path_set_(false)
+    {}
+
+    explicit BasicLocationKeySimple(const LocationKeySimpleView &view):
+        BasicLocationKeySimple()
+    {
+        set_from_view(view);
+    }
+
     void clear() final override
     {
+        invalidate_str();
         c_.device_.clear();
         c_.partition_.clear();
         c_.path_.clear();
@@ -111,42 +176,49 @@ class LocationKeySimple: public ::StrBoUrl::Location
         return is_partition_set_ && is_path_set_ && !c_.device_.empty();
     }
 
-    void set_device(const std::string &device)
+    void set_device(const StringT &device)
     {
+        invalidate_str();
         c_.device_ = device;
     }
 
-    void set_device(std::string &&device)
+    void set_device(StringT &&device)
     {
+        invalidate_str();
         c_.device_ = std::move(device);
     }
 
-    void set_partition(const std::string &partition)
+    void set_partition(const StringT &partition)
     {
+        invalidate_str();
         c_.partition_ = partition;
         is_partition_set_ = true;
     }
 
-    void set_partition(std::string &&partition)
+    void set_partition(StringT &&partition)
     {
+        invalidate_str();
         c_.partition_ = std::move(partition);
         is_partition_set_ = true;
     }
 
-    void set_path(const std::string &path)
+    void set_path(const StringT &path)
     {
+        invalidate_str();
         c_.path_ = path;
         is_path_set_ = true;
     }
 
-    void set_path(std::string &&path)
+    void set_path(StringT &&path)
     {
+        invalidate_str();
         c_.path_ = std::move(path);
         is_path_set_ = true;
     }
 
-    void append_to_path(const std::string &path)
+    void append_to_path(const StringT &path)
     {
+        invalidate_str();
         if(c_.path_.empty())
             set_path(path);
         else
@@ -158,6 +230,7 @@ class LocationKeySimple: public ::StrBoUrl::Location
 
     void append_to_path(const char *path)
     {
+        invalidate_str();
         if(c_.path_.empty())
             set_path(path);
         else
@@ -167,12 +240,44 @@ class LocationKeySimple: public ::StrBoUrl::Location
         }
     }
 
+    /*!
+     * Set object from decoded components of a view.
+     */
+    void set_from_view(const LocationKeySimpleView &view);
+
     const Components &unpack() const { return c_; }
 
+    /*!
+     * Compare components.
+     */
+    friend bool operator==(const BasicLocationKeySimple &a, const BasicLocationKeySimple &b)
+    {
+        return a.is_partition_set_ == b.is_partition_set_ && a.is_path_set_ == b.is_path_set_ &&
+               a.c_.device_ == b.c_.device_ && a.c_.partition_ == b.c_.partition_ &&
+               a.c_.path_ == b.c_.path_;
+    }
+
+    friend bool operator!=(const BasicLocationKeySimple &a, const BasicLocationKeySimple &b) { return !(a == b); }
+
+    /*!
+     * Same as comparison by \c operator==(), there are no item positions.
+     */
+    bool equals_ignoring_positions(const BasicLocationKeySimple &other) const { return *this == other; }
+
+    /*!
+     * URL representation, memoized with the allocator of the location.
+     */
+    const StringT &str() const { return get_memoized_str(str_memo_); }
+
   protected:
+    std::string_view get_str_view() const final override { return str(); }
     const char *get_error_prefix_for_exception() const final override { return get_error_prefix(); }
-    std::string str_impl() const final override;
-    const char *set_url_impl(const std::string &url, size_t offset) final override;
+    size_t encoded_length_impl() const final override;
+    void write_impl(char *out) const final override;
+    void serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const final override;
+    StrBoUrl::ParseResult
+    try_set_url_impl(std::string_view url, size_t offset,
+                     const StrBoUrl::Parse::StructuralIndex &index) noexcept final override;
 
   private:
     static const char *get_error_prefix();
@@ -180,27 +285,83 @@ class LocationKeySimple: public ::StrBoUrl::Location
   public:
     static const ::StrBoUrl::Schema::StrBoLocator &get_scheme()
     {
-        static const ::USB::ResourceLocatorSimple scheme;
+        static constexpr ::USB::ResourceLocatorSimple scheme;
         return scheme;
     }
 };
 
+using LocationKeySimple = BasicLocationKeySimple<std::string>;
+
+namespace pmr
+{
+/*!
+ * Variant of #USB::LocationKeySimple which allocates its components from a
+ * \c std::pmr::memory_resource passed to the constructor.
+ */
+using LocationKeySimple = BasicLocationKeySimple<std::pmr::string>;
+}
+
+/*!
+ * Non-owning view of a USB reference location key.
+ */
+class LocationKeyReferenceView: public ::StrBoUrl::LocationView
+{
+  private:
+    StrBoUrl::FieldRef device_;
+    StrBoUrl::FieldRef partition_;
+    StrBoUrl::FieldRef reference_point_;
+    StrBoUrl::FieldRef item_name_;
+    StrBoUrl::ObjectIndex item_position_;
+
+  public:
+    explicit LocationKeyReferenceView() {}
+
+    void clear() { *this = LocationKeyReferenceView(); }
+
+    /*!
+     * Set view from URL in caller-owned buffer.
+     *
+     * See #StrBoUrl::Location::try_set_url().
+     */
+    StrBoUrl::ParseResult try_set_url(std::string_view url) noexcept;
+
+    StrBoUrl::FieldRef get_device() const { return device_; }
+    StrBoUrl::FieldRef get_partition() const { return partition_; }
+    StrBoUrl::FieldRef get_reference_point() const { return reference_point_; }
+    StrBoUrl::FieldRef get_item_name() const { return item_name_; }
+    StrBoUrl::ObjectIndex get_item_position() const { return item_position_; }
+
+    StrBoUrl::ParseResult
+    parse_fields(std::string_view url, size_t offset,
+                 const StrBoUrl::Parse::StructuralIndex &index) noexcept;
+};
+
 /*!
  * Representation of a USB reference location key.
  */
-class LocationKeyReference: public ::StrBoUrl::Location
+template <typename StringT>
+class BasicLocationKeyReference: public ::StrBoUrl::Location
 {
   public:
+    using allocator_type = typename StringT::allocator_type;
+
     struct Components
     {
-        std::string device_;
-        std::string partition_;
-        std::string reference_point_;
-        std::string item_name_;
+        StrBoUrl::InternedStringFor<StringT> device_;
+        StrBoUrl::InternedStringFor<StringT> partition_;
+        StringT reference_point_;
+        StringT item_name_;
         StrBoUrl::ObjectIndex item_position_;
 
         Components() {}
 
+        explicit Components(const allocator_type &alloc):
+            device_(alloc),
+            partition_(alloc),
+            reference_point_(alloc),
+            item_name_(alloc)
+        {}
+
         explicit Components(const char *device, const char *partition,
                             const char *reference_point, const char *item_name,
                             StrBoUrl::ObjectIndex item_position):
@@ -214,23 +375,45 @@ class LocationKeyReference: public ::StrBoUrl::Location
 
   private:
     Components c_;
+    mutable ::StrBoUrl::MemoizedStr<StringT> str_memo_;
     bool is_partition_set_;
     bool is_reference_point_set_;
     bool is_item_set_;
 
   public:
-    LocationKeyReference(const LocationKeyReference &) = delete;
-    LocationKeyReference &operator=(const LocationKeyReference &) = delete;
+    BasicLocationKeyReference(const BasicLocationKeyReference &) = default;
+    BasicLocationKeyReference(BasicLocationKeyReference &&) = default;
+    BasicLocationKeyReference &operator=(const BasicLocationKeyReference &) = default;
+    BasicLocationKeyReference &operator=(BasicLocationKeyReference &&) = default;
+
+    explicit BasicLocationKeyReference():
+        ::StrBoUrl::Location(get_scheme()),
+        is_partition_set_(false),
+        is_reference_point_set_(false),
+        is_item_set_(false)
+    {}
 
-    explicit LocationKeyReference():
+    /*!
+     * Construct empty location whose components use \p alloc.
+     */
+    explicit BasicLocationKeyReference(const allocator_type &alloc):
         ::StrBoUrl::Location(get_scheme()),
+        c_(alloc),
+        str_memo_(alloc),
         is_partition_set_(false),
         is_reference_point_set_(false),
         is_item_set_(false)
     {}
 
+    explicit BasicLocationKeyReference(const LocationKeyReferenceView &view):
+        BasicLocationKeyReference()
+    {
+        set_from_view(view);
+    }
+
     void clear() final override
     {
+        invalidate_str();
         c_.device_.clear();
         c_.partition_.clear();
         c_.reference_point_.clear();
@@ -245,45 +428,52 @@ class LocationKeyReference: public ::StrBoUrl::Location
     {
         return is_partition_set_ && is_reference_point_set_ && is_item_set_ &&
                !c_.device_.empty() &&
-               c_.item_name_.find('/') == std::string::npos;
+               c_.item_name_.find('/') == StringT::npos;
     }
 
-    void set_device(const std::string &device)
+    void set_device(const StringT &device)
     {
+        invalidate_str();
         c_.device_ = device;
     }
 
-    void set_device(std::string &&device)
+    void set_device(StringT &&device)
     {
+        invalidate_str();
         c_.device_ = std::move(device);
     }
 
-    void set_partition(const std::string &partition)
+    void set_partition(const StringT &partition)
     {
+        invalidate_str();
         c_.partition_ = partition;
         is_partition_set_ = true;
     }
 
-    void set_partition(std::string &&partition)
+    void set_partition(StringT &&partition)
     {
+        invalidate_str();
         c_.partition_ = std::move(partition);
         is_partition_set_ = true;
     }
 
-    void set_reference_point(const std::string &reference_point)
+    void set_reference_point(const StringT &reference_point)
     {
+        invalidate_str();
         c_.reference_point_ = reference_point;
         is_reference_point_set_ = true;
     }
 
-    void set_reference_point(std::string &&reference_point)
+    void set_reference_point(StringT &&reference_point)
     {
+        invalidate_str();
         c_.reference_point_ = std::move(reference_point);
         is_reference_point_set_ = true;
     }
 
-    void append_to_reference_point(const std::string &path)
+    void append_to_reference_point(const StringT &path)
     {
+        invalidate_str();
         if(c_.reference_point_.empty())
             set_reference_point(path);
         else
@@ -295,6 +485,7 @@ class LocationKeyReference: public ::StrBoUrl::Location
 
     void append_to_reference_point(const char *path)
     {
+        invalidate_str();
         if(c_.reference_point_.empty())
             set_reference_point(path);
         else
@@ -304,19 +495,64 @@ class LocationKeyReference: public ::StrBoUrl::Location
         }
     }
 
-    void set_item(const std::string &item_name, StrBoUrl::ObjectIndex item_pos)
+    void set_item(const StringT &item_name, StrBoUrl::ObjectIndex item_pos)
     {
+        invalidate_str();
         c_.item_name_ = item_name;
         c_.item_position_ = item_pos;
         is_item_set_ = true;
     }
 
+    /*!
+     * Set object from decoded components of a view.
+     */
+    void set_from_view(const LocationKeyReferenceView &view);
+
     const Components &unpack() const { return c_; }
 
+    /*!
+     * Compare components, including item positions.
+     */
+    friend bool operator==(const BasicLocationKeyReference &a, const BasicLocationKeyReference &b) { return a.equals(b, true); }
+    friend bool operator!=(const BasicLocationKeyReference &a, const BasicLocationKeyReference &b) { return !a.equals(b, true); }
+
+    /*!
+     * Compare components except for item positions.
+     *
+     * Locations which are equal in this sense refer to the same item.
+     */
+    bool equals_ignoring_positions(const BasicLocationKeyReference &other) const
+    {
+        return equals(other, false);
+    }
+
+    /*!
+     * URL representation, memoized with the allocator of the location.
+     */
+    const StringT &str() const { return get_memoized_str(str_memo_); }
+
+  private:
+    bool equals(const BasicLocationKeyReference &other, bool compare_positions) const
+    {
+        return is_partition_set_ == other.is_partition_set_ &&
+               is_reference_point_set_ == other.is_reference_point_set_ &&
+               is_item_set_ == other.is_item_set_ &&
+               c_.device_ == other.c_.device_ && c_.partition_ == other.c_.partition_ &&
+               c_.reference_point_ == other.c_.reference_point_ &&
+               c_.item_name_ == other.c_.item_name_ &&
+               (!compare_positions ||
+                c_.item_position_.get_object_index() == other.c_.item_position_.get_object_index());
+    }
+
   protected:
+    std::string_view get_str_view() const final override { return str(); }
     const char *get_error_prefix_for_exception() const final override { return get_error_prefix(); }
-    std::string str_impl() const final override;
-    const char *set_url_impl(const std::string &url, size_t offset) final override;
+    size_t encoded_length_impl() const final override;
+    void write_impl(char *out) const final override;
+    void serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const final override;
+    StrBoUrl::ParseResult
+    try_set_url_impl(std::string_view url, size_t offset,
+                     const StrBoUrl::Parse::StructuralIndex &index) noexcept final override;
 
   private:
     static const char *get_error_prefix();
@@ -324,27 +560,83 @@ class LocationKeyReference: public ::StrBoUrl::Location
   public:
     static const ::StrBoUrl::Schema::StrBoLocator &get_scheme()
     {
-        static const ::USB::ResourceLocatorReference scheme;
+        static constexpr ::USB::ResourceLocatorReference scheme;
         return scheme;
     }
 };
 
+using LocationKeyReference = BasicLocationKeyReference<std::string>;
+
+namespace pmr
+{
+/*!
+ * Variant of #USB::LocationKeyReference which allocates its components from a
+ * \c std::pmr::memory_resource passed to the constructor.
+ */
+using LocationKeyReference = BasicLocationKeyReference<std::pmr::string>;
+}
+
+/*!
+ * Non-owning view of a USB location trace.
+ */
+class LocationTraceView: public ::StrBoUrl::LocationView
+{
+  private:
+    StrBoUrl::FieldRef device_;
+    StrBoUrl::FieldRef partition_;
+    StrBoUrl::FieldRef reference_point_;
+    StrBoUrl::FieldRef item_name_;
+    StrBoUrl::ObjectIndex item_position_;
+
+  public:
+    explicit LocationTraceView() {}
+
+    void clear() { *this = LocationTraceView(); }
+
+    /*!
+     * Set view from URL in caller-owned buffer.
+     *
+     * See #StrBoUrl::Location::try_set_url().
+     */
+    StrBoUrl::ParseResult try_set_url(std::string_view url) noexcept;
+
+    StrBoUrl::FieldRef get_device() const { return device_; }
+    StrBoUrl::FieldRef get_partition() const { return partition_; }
+    StrBoUrl::FieldRef get_reference_point() const { return reference_point_; }
+    StrBoUrl::FieldRef get_item_name() const { return item_name_; }
+    StrBoUrl::ObjectIndex get_item_position() const { return item_position_; }
+
+    StrBoUrl::ParseResult
+    parse_fields(std::string_view url, size_t offset,
+                 const StrBoUrl::Parse::StructuralIndex &index) noexcept;
+};
+
 /*!
  * Representation of a USB location trace.
  */
-class LocationTrace: public ::StrBoUrl::Location
+template <typename StringT>
+class BasicLocationTrace: public ::StrBoUrl::Location
 {
   public:
+    using allocator_type = typename StringT::allocator_type;
+
     struct Components
     {
-        std::string device_;
-        std::string partition_;
-        std::string reference_point_;
-        std::string item_name_;
+        StrBoUrl::InternedStringFor<StringT> device_;
+        StrBoUrl::InternedStringFor<StringT> partition_;
+        StringT reference_point_;
+        StringT item_name_;
         StrBoUrl::ObjectIndex item_position_;
 
         Components() {}
 
+        explicit Components(const allocator_type &alloc):
+            device_(alloc),
+            partition_(alloc),
+            reference_point_(alloc),
+            item_name_(alloc)
+        {}
+
         explicit Components(const char *device, const char *partition,
                             const char *reference_point, const char *item_name,
                             StrBoUrl::ObjectIndex item_position):
@@ -358,21 +650,42 @@ class LocationTrace: public ::StrBoUrl::Location
 
   private:
     Components c_;
+    mutable ::StrBoUrl::MemoizedStr<StringT> str_memo_;
     bool is_partition_set_;
     bool is_item_set_;
 
   public:
-    LocationTrace(const LocationTrace &) = delete;
-    LocationTrace &operator=(const LocationTrace &) = delete;
+    BasicLocationTrace(const BasicLocationTrace &) = default;
+    BasicLocationTrace(BasicLocationTrace &&) = default;
+    BasicLocationTrace &operator=(const BasicLocationTrace &) = default;
+    BasicLocationTrace &operator=(BasicLocationTrace &&) = default;
 
-    explicit LocationTrace():
+    explicit BasicLocationTrace():
         ::StrBoUrl::Location(get_scheme()),
         is_partition_set_(false),
         is_item_set_(false)
     {}
 
+    /*!
+     * Construct empty location whose components use \p alloc.
+     */
+    explicit BasicLocationTrace(const allocator_type &alloc):
+        ::StrBoUrl::Location(get_scheme()),
+        c_(alloc),
+        str_memo_(alloc),
+        is_partition_set_(false),
+        is_item_set_(false)
+    {}
+
+    explicit BasicLocationTrace(const LocationTraceView &view):
+        BasicLocationTrace()
+    {
+        set_from_view(view);
+    }
+
     void clear() final override
     {
+        invalidate_str();
         c_.device_.clear();
         c_.partition_.clear();
         c_.reference_point_.clear();
@@ -389,46 +702,53 @@ class LocationTrace: public ::StrBoUrl::Location
 
     size_t get_trace_length() const;
 
-    void set_device(const std::string &device)
+    void set_device(const StringT &device)
     {
+        invalidate_str();
         c_.device_ = device;
     }
 
-    void set_device(std::string &&device)
+    void set_device(StringT &&device)
     {
+        invalidate_str();
         c_.device_ = std::move(device);
     }
 
-    void set_partition(const std::string &partition)
+    void set_partition(const StringT &partition)
     {
+        invalidate_str();
         c_.partition_ = partition;
         is_partition_set_ = true;
     }
 
-    void set_partition(std::string &&partition)
+    void set_partition(StringT &&partition)
     {
+        invalidate_str();
         c_.partition_ = std::move(partition);
         is_partition_set_ = true;
     }
 
-    void set_reference_point(const std::string &reference_point)
+    void set_reference_point(const StringT &reference_point)
     {
+        invalidate_str();
         if(reference_point != "/")
             c_.reference_point_ = reference_point;
         else
             c_.reference_point_.clear();
     }
 
-    void set_reference_point(std::string &&reference_point)
+    void set_reference_point(StringT &&reference_point)
     {
+        invalidate_str();
         if(reference_point != "/")
             c_.reference_point_ = std::move(reference_point);
         else
             c_.reference_point_.clear();
     }
 
-    void append_to_reference_point(const std::string &path)
+    void append_to_reference_point(const StringT &path)
     {
+        invalidate_str();
         if(c_.reference_point_.empty())
             set_reference_point(path);
         else
@@ -440,6 +760,7 @@ class LocationTrace: public ::StrBoUrl::Location
 
     void append_to_reference_point(const char *path)
     {
+        invalidate_str();
         if(c_.reference_point_.empty())
             set_reference_point(path);
         else
@@ -449,15 +770,17 @@ class LocationTrace: public ::StrBoUrl::Location
         }
     }
 
-    void set_item(const std::string &item_name, StrBoUrl::ObjectIndex item_pos)
+    void set_item(const StringT &item_name, StrBoUrl::ObjectIndex item_pos)
     {
+        invalidate_str();
         c_.item_name_ = item_name;
         c_.item_position_ = item_pos;
         is_item_set_ = true;
     }
 
-    void append_item(const std::string &item_name, StrBoUrl::ObjectIndex item_pos)
+    void append_item(const StringT &item_name, StrBoUrl::ObjectIndex item_pos)
     {
+        invalidate_str();
         if(is_item_set_)
             return;
 
@@ -469,8 +792,9 @@ class LocationTrace: public ::StrBoUrl::Location
         is_item_set_ = true;
     }
 
-    void append_to_item_path(const std::string &path)
+    void append_to_item_path(const StringT &path)
     {
+        invalidate_str();
         if(is_item_set_)
             return;
 
@@ -485,6 +809,7 @@ class LocationTrace: public ::StrBoUrl::Location
 
     void append_to_item_path(const char *path)
     {
+        invalidate_str();
         if(is_item_set_)
             return;
 
@@ -497,12 +822,55 @@ class LocationTrace: public ::StrBoUrl::Location
         }
     }
 
+    /*!
+     * Set object from decoded components of a view.
+     */
+    void set_from_view(const LocationTraceView &view);
+
     const Components &unpack() const { return c_; }
 
+    /*!
+     * Compare components, including item positions.
+     */
+    friend bool operator==(const BasicLocationTrace &a, const BasicLocationTrace &b) { return a.equals(b, true); }
+    friend bool operator!=(const BasicLocationTrace &a, const BasicLocationTrace &b) { return !a.equals(b, true); }
+
+    /*!
+     * Compare components except for item positions.
+     *
+     * Locations which are equal in this sense refer to the same item.
+     */
+    bool equals_ignoring_positions(const BasicLocationTrace &other) const
+    {
+        return equals(other, false);
+    }
+
+    /*!
+     * URL representation, memoized with the allocator of the location.
+     */
+    const StringT &str() const { return get_memoized_str(str_memo_); }
+
+  private:
+    bool equals(const BasicLocationTrace &other, bool compare_positions) const
+    {
+        return is_partition_set_ == other.is_partition_set_ &&
+               is_item_set_ == other.is_item_set_ &&
+               c_.device_ == other.c_.device_ && c_.partition_ == other.c_.partition_ &&
+               c_.reference_point_ == other.c_.reference_point_ &&
+               c_.item_name_ == other.c_.item_name_ &&
+               (!compare_positions ||
+                c_.item_position_.get_object_index() == other.c_.item_position_.get_object_index());
+    }
+
   protected:
+    std::string_view get_str_view() const final override { return str(); }
     const char *get_error_prefix_for_exception() const final override { return get_error_prefix(); }
-    std::string str_impl() const final override;
-    const char *set_url_impl(const std::string &url, size_t offset) final override;
+    size_t encoded_length_impl() const final override;
+    void write_impl(char *out) const final override;
+    void serialize_impl(StrBoUrl::Serialize::ChunkSink &sink) const final override;
+    StrBoUrl::ParseResult
+    try_set_url_impl(std::string_view url, size_t offset,
+                     const StrBoUrl::Parse::StructuralIndex &index) noexcept final override;
 
   private:
     static const char *get_error_prefix();
@@ -510,11 +878,45 @@ class LocationTrace: public ::StrBoUrl::Location
   public:
     static const ::StrBoUrl::Schema::StrBoLocator &get_scheme()
     {
-        static const ::USB::TraceLocator scheme;
+        static constexpr ::USB::TraceLocator scheme;
         return scheme;
     }
 };
 
+using LocationTrace = BasicLocationTrace<std::string>;
+
+namespace pmr
+{
+/*!
+ * Variant of #USB::LocationTrace which allocates its components from a
+ * \c std::pmr::memory_resource passed to the constructor.
+ */
+using LocationTrace = BasicLocationTrace<std::pmr::string>;
+}
+
+}
+
+namespace std
+{
+
+template <typename StringT>
+struct hash<USB::BasicLocationKeySimple<StringT>>
+{
+    size_t operator()(const USB::BasicLocationKeySimple<StringT> &l) const { return l.hash(); }
+};
+
+template <typename StringT>
+struct hash<USB::BasicLocationKeyReference<StringT>>
+{
+    size_t operator()(const USB::BasicLocationKeyReference<StringT> &l) const { return l.hash(); }
+};
+
+template <typename StringT>
+struct hash<USB::BasicLocationTrace<StringT>>
+{
+    size_t operator()(const USB::BasicLocationTrace<StringT> &l) const { return l.hash(); }
+};
+
 }
 
 #endif /* !STRBO_URL_USB_HH */
@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_usb_index.hh"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * File layout: header, directory records sorted by path, then for each
+ * directory its path, its table of name offsets, and its names. All offsets
+ * are relative to the start of the file.
+ */
+static constexpr char INDEX_MAGIC[8] = {'S', 'B', 'U', 'S', 'B', 'I', 'D', 'X'};
+static constexpr uint32_t INDEX_VERSION = 1;
+static constexpr uint32_t INDEX_BYTE_ORDER_MARK = 0x01020304;
+
+struct IndexHeader
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t byte_order_mark_;
+    uint64_t number_of_directories_;
+    uint64_t file_size_;
+};
+
+struct IndexRecord
+{
+    uint64_t path_offset_;
+    uint64_t offsets_offset_;
+    uint64_t names_offset_;
+    uint64_t names_size_;
+    int64_t mtime_sec_;
+    int64_t mtime_nsec_;
+    uint32_t path_length_;
+    uint32_t number_of_names_;
+};
+
+static_assert(sizeof(IndexHeader) == 32);
+static_assert(sizeof(IndexRecord) == 56);
+
+static bool is_in_range(uint64_t offset, uint64_t length, size_t size)
+{
+    return offset <= size && length <= size - offset;
+}
+
+int USB::DirectoryIndex::open(const std::string &path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+        return errno;
+
+    struct stat st;
+
+    if(fstat(fd, &st) < 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        return error;
+    }
+
+    if(size_t(st.st_size) < sizeof(IndexHeader))
+    {
+        ::close(fd);
+        return EINVAL;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+
+    if(data == MAP_FAILED)
+        return error;
+
+    IndexHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if(memcmp(header.magic_, INDEX_MAGIC, sizeof(header.magic_)) != 0 ||
+       header.version_ != INDEX_VERSION ||
+       header.byte_order_mark_ != INDEX_BYTE_ORDER_MARK ||
+       header.file_size_ != uint64_t(st.st_size) ||
+       header.number_of_directories_ >
+           (header.file_size_ - sizeof(IndexHeader)) / sizeof(IndexRecord))
+    {
+        munmap(data, st.st_size);
+        return EINVAL;
+    }
+
+    data_ = static_cast<const uint8_t *>(data);
+    size_ = st.st_size;
+    number_of_directories_ = header.number_of_directories_;
+
+    return 0;
+}
+
+void USB::DirectoryIndex::close()
+{
+    if(data_ != nullptr)
+        munmap(const_cast<uint8_t *>(data_), size_);
+
+    data_ = nullptr;
+    size_ = 0;
+    number_of_directories_ = 0;
+}
+
+bool USB::DirectoryIndex::get_directory(size_t i, std::string_view &path,
+                                        Timestamp &mtime,
+                                        ListingView &listing) const
+{
+    const auto *records =
+        reinterpret_cast<const IndexRecord *>(data_ + sizeof(IndexHeader));
+    const IndexRecord &r(records[i]);
+
+    if(!is_in_range(r.path_offset_, r.path_length_, size_) ||
+       !is_in_range(r.names_offset_, r.names_size_, size_) ||
+       r.offsets_offset_ % alignof(uint32_t) != 0 ||
+       !is_in_range(r.offsets_offset_, uint64_t(r.number_of_names_) * sizeof(uint32_t), size_) ||
+       (r.names_size_ > 0 && data_[r.names_offset_ + r.names_size_ - 1] != '\0'))
+        return false;
+
+    path = std::string_view(reinterpret_cast<const char *>(data_ + r.path_offset_),
+                            r.path_length_);
+    mtime = Timestamp(r.mtime_sec_, r.mtime_nsec_);
+    listing = ListingView(reinterpret_cast<const char *>(data_ + r.names_offset_),
+                          r.names_size_,
+                          reinterpret_cast<const uint32_t *>(data_ + r.offsets_offset_),
+                          r.number_of_names_);
+    return true;
+}
+
+bool USB::DirectoryIndex::lookup(std::string_view path, const Timestamp &mtime,
+                                 ListingView &listing) const
+{
+    size_t lo = 0;
+    size_t hi = number_of_directories_;
+
+    while(lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        std::string_view p;
+        Timestamp t;
+        ListingView l;
+
+        if(!get_directory(mid, p, t, l))
+            return false;
+
+        const int cmp = p.compare(path);
+
+        if(cmp < 0)
+            lo = mid + 1;
+        else if(cmp > 0)
+            hi = mid;
+        else if(t != mtime)
+            return false;
+        else
+        {
+            listing = l;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static size_t align_to(size_t offset, size_t alignment)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+static void put(std::string &image, size_t offset, const T &value)
+{
+    memcpy(&image[offset], &value, sizeof(value));
+}
+
+static int write_file(const std::string &path, const std::string &image)
+{
+    /* unique name in the target directory so that concurrent writers do
+     * not clobber each other's data before renaming */
+    std::string temp_path(path + ".XXXXXX");
+    const int fd = mkostemp(&temp_path[0], O_CLOEXEC);
+
+    if(fd < 0)
+        return errno;
+
+    if(fchmod(fd, 0644) < 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        unlink(temp_path.c_str());
+        return error;
+    }
+
+    for(size_t pos = 0; pos < image.length();)
+    {
+        const ssize_t len = ::write(fd, image.data() + pos, image.length() - pos);
+
+        if(len < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            const int error = errno;
+            ::close(fd);
+            unlink(temp_path.c_str());
+            return error;
+        }
+
+        pos += len;
+    }
+
+    if(fsync(fd) < 0 || ::close(fd) < 0)
+    {
+        const int error = errno;
+        unlink(temp_path.c_str());
+        return error;
+    }
+
+    if(rename(temp_path.c_str(), path.c_str()) < 0)
+    {
+        const int error = errno;
+        unlink(temp_path.c_str());
+        return error;
+    }
+
+    return 0;
+}
+
+int USB::DirectoryIndex::write(const std::string &path,
+                               const DirectoryIndexUpdates &updates) const
+{
+    struct Directory
+    {
+        std::string_view path_;
+        Timestamp mtime_;
+        ListingView listing_;
+    };
+
+    /* merge both sorted inputs, entries from updates win */
+    std::vector<Directory> dirs;
+    dirs.reserve(number_of_directories_ + updates.size());
+
+    auto upd(updates.begin());
+
+    for(size_t i = 0; i < number_of_directories_; ++i)
+    {
+        Directory d;
+
+        if(!get_directory(i, d.path_, d.mtime_, d.listing_))
+            continue;
+
+        for(; upd != updates.end() && upd->first < d.path_; ++upd)
+            dirs.push_back({upd->first, upd->second.first,
+                            upd->second.second.get_view()});
+
+        if(upd != updates.end() && upd->first == d.path_)
+            continue;
+
+        if(dirs.empty() || dirs.back().path_ < d.path_)
+            dirs.push_back(d);
+    }
+
+    for(; upd != updates.end(); ++upd)
+        dirs.push_back({upd->first, upd->second.first,
+                        upd->second.second.get_view()});
+
+    /* compute layout */
+    size_t size = sizeof(IndexHeader) + dirs.size() * sizeof(IndexRecord);
+
+    for(const auto &d : dirs)
+    {
+        size += d.path_.length();
+        size = align_to(size, alignof(uint32_t)) + d.listing_.size() * sizeof(uint32_t);
+
+        size_t names_size = 0;
+
+        for(size_t i = 1; i <= d.listing_.size(); ++i)
+            names_size += d.listing_.get_name(StrBoUrl::ObjectIndex(i)).length() + 1;
+
+        /* name offsets are stored as 32 bit values */
+        if(names_size > UINT32_MAX)
+            return EFBIG;
+
+        size += names_size;
+    }
+
+    std::string image(size, '\0');
+
+    IndexHeader header;
+    memcpy(header.magic_, INDEX_MAGIC, sizeof(header.magic_));
+    header.version_ = INDEX_VERSION;
+    header.byte_order_mark_ = INDEX_BYTE_ORDER_MARK;
+    header.number_of_directories_ = dirs.size();
+    header.file_size_ = size;
+    put(image, 0, header);
+
+    size_t pos = sizeof(IndexHeader) + dirs.size() * sizeof(IndexRecord);
+
+    for(size_t i = 0; i < dirs.size(); ++i)
+    {
+        const auto &d(dirs[i]);
+        IndexRecord r;
+
+        r.path_offset_ = pos;
+        r.path_length_ = d.path_.length();
+        memcpy(&image[pos], d.path_.data(), d.path_.length());
+        pos = align_to(pos + d.path_.length(), alignof(uint32_t));
+
+        r.offsets_offset_ = pos;
+        r.number_of_names_ = d.listing_.size();
+        r.names_offset_ = pos + d.listing_.size() * sizeof(uint32_t);
+
+        size_t names_pos = r.names_offset_;
+
+        for(size_t j = 1; j <= d.listing_.size(); ++j)
+        {
+            const auto name(d.listing_.get_name(StrBoUrl::ObjectIndex(j)));
+            put(image, pos, uint32_t(names_pos - r.names_offset_));
+            pos += sizeof(uint32_t);
+            memcpy(&image[names_pos], name.data(), name.length());
+            names_pos += name.length() + 1;
+        }
+
+        r.names_size_ = names_pos - r.names_offset_;
+        r.mtime_sec_ = d.mtime_.sec_;
+        r.mtime_nsec_ = d.mtime_.nsec_;
+        put(image, sizeof(IndexHeader) + i * sizeof(IndexRecord), r);
+
+        pos = names_pos;
+    }
+
+    return write_file(path, image);
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_USB_INDEX_HH
+#define STRBO_URL_USB_INDEX_HH
+
+#include "strbo_url_usb_listing.hh"
+
+#include <map>
+
+namespace USB
+{
+
+/*!
+ * Modification time of a directory, used for validating indexed listings.
+ */
+struct Timestamp
+{
+    int64_t sec_;
+    int64_t nsec_;
+
+    explicit Timestamp(int64_t sec = 0, int64_t nsec = 0):
+        sec_(sec),
+        nsec_(nsec)
+    {}
+
+    bool operator==(const Timestamp &other) const
+    {
+        return sec_ == other.sec_ && nsec_ == other.nsec_;
+    }
+
+    bool operator!=(const Timestamp &other) const { return !(*this == other); }
+};
+
+/*!
+ * Directory listings to be written to a #USB::DirectoryIndex.
+ *
+ * Directories are identified by their paths relative to the resolver root,
+ * i.e., <tt>device/partition[/path]</tt>.
+ */
+using DirectoryIndexUpdates =
+    std::map<std::string, std::pair<Timestamp, DirectoryListing>, std::less<>>;
+
+/*!
+ * Persistent index of directory listings, mapped read-only into memory.
+ *
+ * The index maps directory paths to sorted name tables as stored in
+ * #USB::DirectoryListing objects, together with the modification times of
+ * the directories at the time they were read. An indexed listing is only
+ * handed out if the caller passes the current modification time of the
+ * directory, so stale parts of the index are simply ignored and can be
+ * replaced by writing an updated index using #USB::DirectoryIndex::write().
+ *
+ * Looking up a listing touches the header, a few records found by binary
+ * search over the sorted directory table, and the name table of the
+ * directory itself. Nothing is read from the file when it is opened.
+ *
+ * The file format uses host byte order and is not meant to be exchanged
+ * between systems.
+ */
+class DirectoryIndex
+{
+  private:
+    const uint8_t *data_;
+    size_t size_;
+    size_t number_of_directories_;
+
+  public:
+    DirectoryIndex(const DirectoryIndex &) = delete;
+    DirectoryIndex &operator=(const DirectoryIndex &) = delete;
+
+    explicit DirectoryIndex():
+        data_(nullptr),
+        size_(0),
+        number_of_directories_(0)
+    {}
+
+    ~DirectoryIndex() { close(); }
+
+    /*!
+     * Map index file \p path, replacing the currently mapped index.
+     *
+     * \returns
+     *     Zero on success, an \c errno value on failure. Files not in index
+     *     format are rejected with \c EINVAL.
+     */
+    int open(const std::string &path);
+
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+
+    size_t get_number_of_directories() const { return number_of_directories_; }
+
+    /*!
+     * Find listing of directory \p path indexed at time \p mtime.
+     *
+     * \returns
+     *     True if the directory is in the index and its modification time
+     *     is \p mtime, false otherwise.
+     */
+    bool lookup(std::string_view path, const Timestamp &mtime,
+                ListingView &listing) const;
+
+    /*!
+     * Write index containing this index merged with \p updates to \p path.
+     *
+     * Directories in \p updates replace those in this index. The file is
+     * written to a temporary file first and then renamed, so that indexes
+     * currently mapped by other objects are not affected. This object is
+     * not modified; call #USB::DirectoryIndex::open() to map the new index.
+     *
+     * \returns
+     *     Zero on success, an \c errno value on failure.
+     */
+    int write(const std::string &path, const DirectoryIndexUpdates &updates) const;
+
+  private:
+    bool get_directory(size_t i, std::string_view &path, Timestamp &mtime,
+                       ListingView &listing) const;
+};
+
+}
+
+#endif /* !STRBO_URL_USB_INDEX_HH */
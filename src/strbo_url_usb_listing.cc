@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_usb_listing.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif /* __linux__ */
+
+#if !defined(SYS_getdents64)
+#include <dirent.h>
+#endif /* !SYS_getdents64 */
+
+static bool is_dot_or_dot_dot(const char *name)
+{
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+#if defined(SYS_getdents64)
+
+/*
+ * Read all entries using large getdents64() reads. Records are parsed by
+ * offset because struct linux_dirent64 is not declared by all C libraries.
+ */
+template <typename AddFn>
+static int read_entries(int fd, AddFn &&add)
+{
+    static constexpr size_t RECLEN_OFFSET = 16;
+    static constexpr size_t NAME_OFFSET = 19;
+
+    alignas(8) char buffer[32 * 1024];
+
+    while(true)
+    {
+        const long len = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+
+        if(len == 0)
+            return 0;
+
+        if(len < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            return errno;
+        }
+
+        for(long pos = 0; pos < len;)
+        {
+            uint16_t reclen;
+            memcpy(&reclen, buffer + pos + RECLEN_OFFSET, sizeof(reclen));
+
+            const char *name = buffer + pos + NAME_OFFSET;
+
+            if(!is_dot_or_dot_dot(name))
+                add(name);
+
+            pos += reclen;
+        }
+    }
+}
+
+#else /* !SYS_getdents64 */
+
+template <typename AddFn>
+static int read_entries(int fd, AddFn &&add)
+{
+    DIR *dir = fdopendir(dup(fd));
+
+    if(dir == nullptr)
+        return errno;
+
+    errno = 0;
+
+    for(const struct dirent *d = readdir(dir); d != nullptr; d = readdir(dir))
+        if(!is_dot_or_dot_dot(d->d_name))
+            add(d->d_name);
+
+    const int error = errno;
+    closedir(dir);
+    return error;
+}
+
+#endif /* SYS_getdents64 */
+
+int USB::DirectoryListing::read(const std::string &path)
+{
+    names_.clear();
+    offsets_.clear();
+
+    const int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if(fd < 0)
+        return errno;
+
+    const int error = read_entries(fd,
+        [this] (const char *name)
+        {
+            offsets_.push_back(names_.length());
+            names_.append(name, strlen(name) + 1);
+        });
+
+    close(fd);
+
+    if(error != 0)
+    {
+        names_.clear();
+        offsets_.clear();
+        return error;
+    }
+
+    std::sort(offsets_.begin(), offsets_.end(),
+              [this] (uint32_t a, uint32_t b)
+              {
+                  return strcmp(names_.data() + a, names_.data() + b) < 0;
+              });
+
+    return 0;
+}
+
+StrBoUrl::ObjectIndex USB::ListingView::find(std::string_view name) const
+{
+    size_t lo = 0;
+    size_t hi = count_;
+
+    while(lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if(get_name(StrBoUrl::ObjectIndex(mid + 1)) < name)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if(lo == count_ || get_name(StrBoUrl::ObjectIndex(lo + 1)) != name)
+        return StrBoUrl::ObjectIndex();
+
+    return StrBoUrl::ObjectIndex(lo + 1);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_USB_LISTING_HH
+#define STRBO_URL_USB_LISTING_HH
+
+#include "strbo_url_usb.hh"
+
+namespace USB
+{
+
+/*!
+ * Read-only view of a sorted directory listing.
+ *
+ * The view refers to a zero-separated block of names and a table of offsets
+ * into that block, sorted by byte-wise comparison of the names. Views are
+ * handed out by #USB::DirectoryListing and #USB::DirectoryIndex and do not
+ * own the data they refer to.
+ */
+class ListingView
+{
+  private:
+    const char *names_;
+    size_t names_size_;
+    const uint32_t *offsets_;
+    size_t count_;
+
+  public:
+    explicit ListingView():
+        names_(nullptr),
+        names_size_(0),
+        offsets_(nullptr),
+        count_(0)
+    {}
+
+    /*!
+     * View of \p count names.
+     *
+     * The block of names must end with a zero byte. Offsets outside the
+     * block are tolerated and yield empty names.
+     */
+    explicit ListingView(const char *names, size_t names_size,
+                         const uint32_t *offsets, size_t count):
+        names_(names),
+        names_size_(names_size),
+        offsets_(offsets),
+        count_(count)
+    {}
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    /*!
+     * Name at position \p pos, starting at 1.
+     */
+    std::string_view get_name(StrBoUrl::ObjectIndex pos) const
+    {
+        const uint32_t offset = offsets_[pos.get_object_index() - 1];
+        return offset < names_size_
+            ? std::string_view(names_ + offset)
+            : std::string_view();
+    }
+
+    /*!
+     * Check if \p name is at position \p pos.
+     */
+    bool is_at(std::string_view name, StrBoUrl::ObjectIndex pos) const
+    {
+        return pos.is_valid() && pos.get_object_index() <= count_ &&
+               get_name(pos) == name;
+    }
+
+    /*!
+     * Position of \p name by binary search, or invalid index if not found.
+     */
+    StrBoUrl::ObjectIndex find(std::string_view name) const;
+};
+
+/*!
+ * Sorted listing of the names in a directory.
+ *
+ * Entries are sorted by byte-wise comparison of their names, and "." and
+ * ".." are not listed. Positions in the listing are the positions expected
+ * by #StrBoUrl::ObjectIndex hints in USB locations. All names are stored in
+ * a single zero-separated string.
+ */
+class DirectoryListing
+{
+  private:
+    std::string names_;
+    std::vector<uint32_t> offsets_;
+
+  public:
+    explicit DirectoryListing() {}
+
+    /*!
+     * Read directory \p path, replacing the current contents.
+     *
+     * \returns
+     *     Zero on success, an \c errno value on failure.
+     */
+    int read(const std::string &path);
+
+    size_t size() const { return offsets_.size(); }
+    bool empty() const { return offsets_.empty(); }
+
+    ListingView get_view() const
+    {
+        return ListingView(names_.data(), names_.length(),
+                           offsets_.data(), offsets_.size());
+    }
+
+    /*!
+     * Name at position \p pos, starting at 1.
+     */
+    std::string_view get_name(StrBoUrl::ObjectIndex pos) const
+    {
+        return get_view().get_name(pos);
+    }
+
+    bool is_at(std::string_view name, StrBoUrl::ObjectIndex pos) const
+    {
+        return get_view().is_at(name, pos);
+    }
+
+    StrBoUrl::ObjectIndex find(std::string_view name) const
+    {
+        return get_view().find(name);
+    }
+
+    /*!
+     * Number of bytes allocated by the listing.
+     */
+    size_t get_memory_usage() const
+    {
+        return names_.capacity() + offsets_.capacity() * sizeof(uint32_t);
+    }
+};
+
+}
+
+#endif /* !STRBO_URL_USB_LISTING_HH */
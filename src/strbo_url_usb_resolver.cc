@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_usb_resolver.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/stat.h>
+
+bool USB::Resolver::forget(std::string_view path)
+{
+    const auto it(cache_.find(path));
+
+    if(it == cache_.end())
+        return false;
+
+    const auto lru_it(it->second);
+    cache_.erase(it);
+
+    std::string removed(std::move(lru_it->first));
+    lru_.erase(lru_it);
+
+    if(cache_event_fn_ != nullptr)
+        cache_event_fn_(removed, false);
+
+    return true;
+}
+
+size_t USB::Resolver::forget_tree(std::string_view path)
+{
+    std::vector<std::string> paths;
+
+    for(const auto &entry : lru_)
+    {
+        const std::string_view p(entry.first);
+
+        if(p.substr(0, path.length()) == path &&
+           (p.length() == path.length() || p[path.length()] == '/'))
+            paths.emplace_back(p);
+    }
+
+    for(const auto &p : paths)
+        forget(p);
+
+    return paths.size();
+}
+
+void USB::Resolver::clear_cache()
+{
+    LRUList removed;
+    removed.swap(lru_);
+    cache_.clear();
+
+    if(cache_event_fn_ != nullptr)
+        for(const auto &entry : removed)
+            cache_event_fn_(entry.first, false);
+}
+
+const USB::DirectoryListing *
+USB::Resolver::get_listing(const std::string &path, int &error)
+{
+    const auto it(cache_.find(path));
+
+    if(it != cache_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return &it->second->second;
+    }
+
+    if(lru_.size() >= max_cached_listings_)
+        forget(lru_.back().first);
+
+    /* the handler must see the directory before it is read so that any
+     * change made while reading is reported after the listing is cached */
+    const bool is_cached = cache_event_fn_ == nullptr || cache_event_fn_(path, true);
+
+    DirectoryListing listing;
+    error = listing.read(path);
+
+    if(error != 0)
+    {
+        if(is_cached && cache_event_fn_ != nullptr)
+            cache_event_fn_(path, false);
+
+        return nullptr;
+    }
+
+    if(!is_cached)
+    {
+        uncached_listing_ = std::move(listing);
+        return &uncached_listing_;
+    }
+
+    lru_.emplace_front(path, std::move(listing));
+    cache_.emplace(lru_.front().first, lru_.begin());
+
+    return &lru_.front().second;
+}
+
+bool USB::Resolver::get_view(const std::string &path, ListingView &listing,
+                             int &error)
+{
+    if(index_path_.empty() || cache_.find(path) != cache_.end())
+    {
+        const auto *l = get_listing(path, error);
+
+        if(l == nullptr)
+            return false;
+
+        listing = l->get_view();
+        return true;
+    }
+
+    /* read modification time before reading the directory so that changes
+     * made while reading will be noticed next time */
+    struct stat st;
+
+    if(stat(path.c_str(), &st) < 0)
+    {
+        error = errno;
+        return false;
+    }
+
+    if(!S_ISDIR(st.st_mode))
+    {
+        error = ENOTDIR;
+        return false;
+    }
+
+    const Timestamp mtime(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+    const std::string_view relative_path(std::string_view(path).substr(root_.length() + 1));
+
+    if(index_.lookup(relative_path, mtime, listing))
+    {
+        ++index_hits_;
+        return true;
+    }
+
+    const auto *l = get_listing(path, error);
+
+    if(l == nullptr)
+        return false;
+
+    auto &update(index_updates_[std::string(relative_path)]);
+    update.first = mtime;
+    update.second = *l;
+
+    listing = l->get_view();
+    return true;
+}
+
+int USB::Resolver::attach_index(std::string path)
+{
+    index_path_ = std::move(path);
+    index_updates_.clear();
+    return index_.open(index_path_);
+}
+
+int USB::Resolver::save_index()
+{
+    if(index_path_.empty())
+        return EINVAL;
+
+    if(index_updates_.empty() && index_.is_open())
+        return 0;
+
+    int error = index_.write(index_path_, index_updates_);
+
+    if(error != 0)
+        return error;
+
+    index_updates_.clear();
+    error = index_.open(index_path_);
+
+    return error;
+}
+
+/*
+ * Names must not be able to leave the mount point.
+ */
+static bool is_valid_name(std::string_view name)
+{
+    return !name.empty() && name != "." && name != ".." &&
+           name.find('/') == std::string_view::npos &&
+           name.find('\0') == std::string_view::npos;
+}
+
+static bool is_valid_path(std::string_view path)
+{
+    size_t start = 0;
+
+    while(start <= path.length())
+    {
+        const size_t end = std::min(path.find('/', start), path.length());
+
+        if(!is_valid_name(path.substr(start, end - start)))
+            return false;
+
+        start = end + 1;
+    }
+
+    return true;
+}
+
+static USB::Resolver::Status errno_to_status(int error)
+{
+    return error == ENOENT || error == ENOTDIR
+        ? USB::Resolver::Status::NOT_FOUND
+        : USB::Resolver::Status::IO_ERROR;
+}
+
+USB::Resolver::Result
+USB::Resolver::resolve(std::string_view device, std::string_view partition,
+                       std::string_view reference_point, std::string_view item_path,
+                       StrBoUrl::ObjectIndex item_position)
+{
+    if(!is_valid_name(device) || !is_valid_name(partition) ||
+       (!reference_point.empty() && !is_valid_path(reference_point)) ||
+       !is_valid_path(item_path))
+        return Result(Status::INVALID_LOCATION);
+
+    std::string dir;
+    dir.reserve(root_.length() + device.length() + partition.length() +
+                reference_point.length() + item_path.length() + 4);
+    dir = root_;
+    dir += '/';
+    dir += device;
+    dir += '/';
+    dir += partition;
+
+    if(!reference_point.empty())
+    {
+        dir += '/';
+        dir += reference_point;
+    }
+
+    size_t start = 0;
+
+    while(true)
+    {
+        const size_t end = std::min(item_path.find('/', start), item_path.length());
+        const auto name(item_path.substr(start, end - start));
+        const bool is_last = end == item_path.length();
+
+        ListingView listing;
+        int error;
+
+        if(!get_view(dir, listing, error))
+            return Result(errno_to_status(error));
+
+        Result result(Status::OK);
+
+        if(is_last && listing.is_at(name, item_position))
+        {
+            result.position_ = item_position;
+            result.is_position_hint_correct_ = true;
+        }
+        else
+            result.position_ = listing.find(name);
+
+        if(!result.position_.is_valid())
+            return Result(Status::NOT_FOUND);
+
+        dir += '/';
+        dir += name;
+
+        if(is_last)
+        {
+            result.path_ = std::move(dir);
+            return result;
+        }
+
+        start = end + 1;
+    }
+}
+
+template <typename StringT>
+USB::Resolver::Result USB::Resolver::resolve(const BasicLocationKeyReference<StringT> &l)
+{
+    if(!l.is_valid())
+        return Result(Status::INVALID_LOCATION);
+
+    const auto &c(l.unpack());
+    return resolve(c.device_, c.partition_, c.reference_point_, c.item_name_,
+                   c.item_position_);
+}
+
+template <typename StringT>
+USB::Resolver::Result USB::Resolver::resolve(const BasicLocationTrace<StringT> &l)
+{
+    if(!l.is_valid())
+        return Result(Status::INVALID_LOCATION);
+
+    const auto &c(l.unpack());
+    return resolve(c.device_, c.partition_, c.reference_point_, c.item_name_,
+                   c.item_position_);
+}
+
+template USB::Resolver::Result USB::Resolver::resolve(const BasicLocationKeyReference<std::string> &);
+template USB::Resolver::Result USB::Resolver::resolve(const BasicLocationKeyReference<std::pmr::string> &);
+template USB::Resolver::Result USB::Resolver::resolve(const BasicLocationTrace<std::string> &);
+template USB::Resolver::Result USB::Resolver::resolve(const BasicLocationTrace<std::pmr::string> &);
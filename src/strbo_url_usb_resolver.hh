@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_USB_RESOLVER_HH
+#define STRBO_URL_USB_RESOLVER_HH
+
+#include "strbo_url_usb_index.hh"
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace USB
+{
+
+/*!
+ * Map USB reference keys and traces to filesystem paths.
+ *
+ * Partitions are expected to be mounted at <tt>root/device/partition</tt>.
+ * The item of a location is first looked up at its position hint in the
+ * sorted listing of its directory, and by name only if the hint doesn't
+ * match. Directories on the item path of a trace are looked up by name.
+ *
+ * Listings are kept in a cache with least-recently-used eviction. The cache
+ * is not updated automatically; use #USB::Resolver::forget() or
+ * #USB::Resolver::clear_cache() when directories are known to have changed.
+ * Resolvers are not thread-safe.
+ *
+ * Optionally, a persistent #USB::DirectoryIndex can be attached so that
+ * resolution after a restart does not need to read each directory on the
+ * path again. Directories not in the cache are then checked against the
+ * index by their modification times, and only stale or missing directories
+ * are read. Their listings are collected and written to the index by
+ * #USB::Resolver::save_index().
+ *
+ * A handler can be installed to get notified about listings entering and
+ * leaving the cache, e.g., for invalidating them automatically (see
+ * #USB::DirectoryWatcher).
+ */
+class Resolver
+{
+  public:
+    enum class Status: uint8_t
+    {
+        OK,
+        INVALID_LOCATION,
+        NOT_FOUND,
+        IO_ERROR,
+    };
+
+    struct Result
+    {
+        Status status_;
+
+        /*! Path of the item, empty unless resolution was successful. */
+        std::string path_;
+
+        /*! Actual position of the item in its directory. */
+        StrBoUrl::ObjectIndex position_;
+
+        /*! Whether or not the item was found at its position hint. */
+        bool is_position_hint_correct_;
+
+        explicit Result(Status status = Status::NOT_FOUND):
+            status_(status),
+            is_position_hint_correct_(false)
+        {}
+    };
+
+    /*!
+     * Called with the path of a directory whose listing is about to be
+     * added to the cache (\p is_added is true) or has been removed from it.
+     *
+     * When a listing is about to be added, the handler is called before the
+     * directory is read, so it can start watching the directory without
+     * missing changes made while reading. It may return false to keep the
+     * listing out of the cache. If reading fails after the handler has
+     * returned true, the handler is called again as if the listing had been
+     * removed. The return value is ignored for removals.
+     */
+    using CacheEventFn = std::function<bool(const std::string &path, bool is_added)>;
+
+  private:
+    using LRUList = std::list<std::pair<std::string, DirectoryListing>>;
+
+    const std::string root_;
+    const size_t max_cached_listings_;
+
+    LRUList lru_;
+    std::unordered_map<std::string_view, LRUList::iterator> cache_;
+    DirectoryListing uncached_listing_;
+    CacheEventFn cache_event_fn_;
+
+    std::string index_path_;
+    DirectoryIndex index_;
+    DirectoryIndexUpdates index_updates_;
+    size_t index_hits_;
+
+  public:
+    Resolver(const Resolver &) = delete;
+    Resolver &operator=(const Resolver &) = delete;
+
+    explicit Resolver(std::string root, size_t max_cached_listings = 64):
+        root_(std::move(root)),
+        max_cached_listings_(max_cached_listings > 0 ? max_cached_listings : 1),
+        index_hits_(0)
+    {}
+
+    const std::string &get_root() const { return root_; }
+
+    template <typename StringT>
+    Result resolve(const BasicLocationKeyReference<StringT> &l);
+
+    template <typename StringT>
+    Result resolve(const BasicLocationTrace<StringT> &l);
+
+    /*!
+     * Remove listing of directory \p path from the cache.
+     */
+    bool forget(std::string_view path);
+
+    /*!
+     * Remove listings of directory \p path and all its subdirectories.
+     *
+     * \returns
+     *     Number of listings removed from the cache.
+     */
+    size_t forget_tree(std::string_view path);
+
+    void clear_cache();
+
+    void set_cache_event_handler(CacheEventFn &&fn) { cache_event_fn_ = std::move(fn); }
+
+    size_t get_number_of_cached_listings() const { return lru_.size(); }
+
+    /*!
+     * Cached listing of directory \p path, reading it if necessary.
+     *
+     * \returns
+     *     Pointer to the listing, valid until the next call of a non-const
+     *     function member, or \c nullptr with \p error set to the \c errno
+     *     value on failure.
+     */
+    const DirectoryListing *get_listing(const std::string &path, int &error);
+
+    /*!
+     * Use persistent directory index stored in file \p path.
+     *
+     * The index file need not exist yet; it is created by
+     * #USB::Resolver::save_index().
+     *
+     * \returns
+     *     Zero if the index has been mapped, an \c errno value otherwise.
+     *     The index path is kept in any case.
+     */
+    int attach_index(std::string path);
+
+    /*!
+     * Write listings read since the last call to the index file.
+     *
+     * The updated index is mapped after it has been written. Updates are
+     * kept in memory until this function succeeds.
+     *
+     * \returns
+     *     Zero on success, an \c errno value on failure.
+     */
+    int save_index();
+
+    size_t get_number_of_pending_index_updates() const { return index_updates_.size(); }
+
+    /*!
+     * Number of directory listings taken from the persistent index.
+     */
+    size_t get_number_of_index_hits() const { return index_hits_; }
+
+  private:
+    bool get_view(const std::string &path, ListingView &listing, int &error);
+
+    Result resolve(std::string_view device, std::string_view partition,
+                   std::string_view reference_point, std::string_view item_path,
+                   StrBoUrl::ObjectIndex item_position);
+};
+
+}
+
+#endif /* !STRBO_URL_USB_RESOLVER_HH */
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_usb_watcher.hh"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static constexpr uint32_t WATCH_MASK =
+    IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+int USB::DirectoryWatcher::open()
+{
+    close();
+
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if(fd_ < 0)
+        return errno;
+
+    resolver_.clear_cache();
+    resolver_.set_cache_event_handler(
+        [this] (const std::string &path, bool is_added)
+        {
+            if(is_added)
+                return add_watch(path);
+
+            remove_watch(path);
+            return true;
+        });
+
+    return 0;
+}
+
+void USB::DirectoryWatcher::close()
+{
+    if(fd_ < 0)
+        return;
+
+    resolver_.set_cache_event_handler(nullptr);
+    watches_.clear();
+    paths_.clear();
+
+    ::close(fd_);
+    fd_ = -1;
+}
+
+bool USB::DirectoryWatcher::add_watch(const std::string &path)
+{
+    if(paths_.size() >= max_watches_)
+        return false;
+
+    const int wd = inotify_add_watch(fd_, path.c_str(), WATCH_MASK);
+
+    if(wd < 0)
+        return false;
+
+    /* the same directory may be watched under another name already */
+    const auto it(paths_.find(wd));
+
+    if(it != paths_.end())
+        return it->second == path;
+
+    const auto &p(paths_.emplace(wd, path).first->second);
+    watches_.emplace(p, wd);
+
+    return true;
+}
+
+void USB::DirectoryWatcher::remove_watch(const std::string &path)
+{
+    const auto it(watches_.find(path));
+
+    if(it == watches_.end())
+        return;
+
+    const int wd = it->second;
+    watches_.erase(it);
+    paths_.erase(wd);
+    inotify_rm_watch(fd_, wd);
+}
+
+size_t USB::DirectoryWatcher::process_events()
+{
+    if(fd_ < 0)
+        return 0;
+
+    alignas(struct inotify_event) char buffer[4096];
+    size_t evicted = 0;
+
+    while(true)
+    {
+        const ssize_t len = read(fd_, buffer, sizeof(buffer));
+
+        if(len < 0 && errno == EINTR)
+            continue;
+
+        if(len <= 0)
+            break;
+
+        for(ssize_t pos = 0; pos < len;)
+        {
+            struct inotify_event ev;
+            memcpy(&ev, buffer + pos, sizeof(ev));
+            const char *name = buffer + pos + sizeof(ev);
+            pos += sizeof(ev) + ev.len;
+
+            if((ev.mask & IN_Q_OVERFLOW) != 0)
+            {
+                evicted += resolver_.get_number_of_cached_listings();
+                resolver_.clear_cache();
+                continue;
+            }
+
+            const auto it(paths_.find(ev.wd));
+
+            if(it == paths_.end())
+                continue;
+
+            /* copy, the watch is removed while forgetting the listing */
+            const std::string path(it->second);
+
+            if((ev.mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_IGNORED)) != 0)
+            {
+                evicted += resolver_.forget_tree(path);
+                remove_watch(path);
+                continue;
+            }
+
+            if(resolver_.forget(path))
+                ++evicted;
+
+            if((ev.mask & IN_ISDIR) != 0 && ev.len > 0 &&
+               (ev.mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+                evicted += resolver_.forget_tree(path + '/' + name);
+        }
+    }
+
+    return evicted;
+}
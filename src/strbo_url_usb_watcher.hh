@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_USB_WATCHER_HH
+#define STRBO_URL_USB_WATCHER_HH
+
+#include "strbo_url_usb_resolver.hh"
+
+namespace USB
+{
+
+/*!
+ * Invalidate cached listings of a #USB::Resolver using inotify.
+ *
+ * Each directory listing in the resolver cache gets a watch for changes of
+ * the directory entries. Events are read by
+ * #USB::DirectoryWatcher::process_events(), which evicts only the listings
+ * of the directories that have changed (including those below directories
+ * which have been moved or removed). Changes of file contents do not affect
+ * listings and are not watched.
+ *
+ * Watches are added before the resolver reads a directory. Changes made
+ * while reading cause an event, and the listing is evicted and read again
+ * when the event is processed.
+ *
+ * The file descriptor returned by #USB::DirectoryWatcher::get_fd() is
+ * non-blocking and is meant to be polled by the main loop. Events which have
+ * not been processed yet do not affect resolution, so resolving a location
+ * right after a change may still use the old listing.
+ *
+ * The number of watches is limited by \p max_watches. Listings which cannot
+ * be watched are not cached by the resolver, so this limit should not be
+ * lower than the resolver cache size.
+ */
+class DirectoryWatcher
+{
+  private:
+    Resolver &resolver_;
+    const size_t max_watches_;
+    int fd_;
+
+    std::unordered_map<int, std::string> paths_;
+    std::unordered_map<std::string_view, int> watches_;
+
+  public:
+    DirectoryWatcher(const DirectoryWatcher &) = delete;
+    DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+    explicit DirectoryWatcher(Resolver &resolver, size_t max_watches = 64):
+        resolver_(resolver),
+        max_watches_(max_watches),
+        fd_(-1)
+    {}
+
+    ~DirectoryWatcher() { close(); }
+
+    /*!
+     * Create inotify instance and start watching the resolver cache.
+     *
+     * Listings cached before this call are removed from the cache because
+     * they cannot be watched retroactively.
+     *
+     * \returns
+     *     Zero on success, an \c errno value on failure.
+     */
+    int open();
+
+    /*!
+     * Stop watching, leaving the resolver cache alone.
+     */
+    void close();
+
+    int get_fd() const { return fd_; }
+
+    size_t get_number_of_watches() const { return paths_.size(); }
+
+    /*!
+     * Read all pending events without blocking and evict affected listings.
+     *
+     * \returns
+     *     Number of listings removed from the resolver cache.
+     */
+    size_t process_events();
+
+  private:
+    bool add_watch(const std::string &path);
+    void remove_watch(const std::string &path);
+};
+
+}
+
+#endif /* !STRBO_URL_USB_WATCHER_HH */
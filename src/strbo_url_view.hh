@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRBO_URL_VIEW_HH
+#define STRBO_URL_VIEW_HH
+
+#include "strbo_url_helpers.hh"
+
+namespace StrBoUrl
+{
+
+/*!
+ * Position and length of an encoded URL component in the URL buffer.
+ */
+class FieldRef
+{
+  private:
+    uint32_t offset_;
+    uint32_t length_;
+
+  public:
+    constexpr explicit FieldRef():
+        offset_(0),
+        length_(0)
+    {}
+
+    constexpr explicit FieldRef(size_t begin, size_t end):
+        offset_(begin),
+        length_(end > begin ? end - begin : 0)
+    {}
+
+    size_t get_offset() const { return offset_; }
+    size_t get_length() const { return length_; }
+    bool empty() const { return length_ == 0; }
+};
+
+/*!
+ * Base class for non-owning views of Streaming Board location URLs.
+ *
+ * A view refers to a URL buffer owned by the caller and only stores the
+ * positions of the URL components, so parsing into a view does not allocate
+ * and views are cheap to copy. Components are URL-decoded on demand. The
+ * buffer must remain valid and unchanged as long as the view is used.
+ *
+ * A view is valid if it has been set successfully from a URL.
+ */
+class LocationView
+{
+  protected:
+    const char *url_;
+    uint32_t url_length_;
+
+    constexpr explicit LocationView():
+        url_(nullptr),
+        url_length_(0)
+    {}
+
+    void set_url_buffer(std::string_view url)
+    {
+        url_ = url.data();
+        url_length_ = url.length();
+    }
+
+  public:
+    bool is_valid() const { return url_ != nullptr; }
+
+    /*!
+     * The URL the view refers to, or an empty view for invalid views.
+     */
+    std::string_view get_url() const
+    {
+        return url_ != nullptr ? std::string_view(url_, url_length_) : std::string_view();
+    }
+
+    /*!
+     * The URL-encoded component as found in the URL.
+     */
+    std::string_view raw(FieldRef field) const
+    {
+        return std::string_view(url_ + field.get_offset(), field.get_length());
+    }
+
+    /*!
+     * URL-decode component, passing the decoded data to \p apply in chunks.
+     *
+     * The callback may be any callable taking a pointer and a length.
+     */
+    template <typename ApplyFn>
+    void decode(FieldRef field, ApplyFn &&apply) const
+    {
+        for_each_url_decoded_chunk(url_ + field.get_offset(), field.get_length(),
+                                   std::forward<ApplyFn>(apply));
+    }
+
+    /*!
+     * URL-decode component, replacing the contents of \p dest.
+     */
+    void decode(FieldRef field, std::string &dest) const
+    {
+        url_decode(url_ + field.get_offset(), field.get_length(), dest,
+                   [] (ParseResult::Code, const char *) {});
+    }
+
+    /*!
+     * URL-decode component into any string type, e.g., \c std::pmr::string.
+     */
+    template <typename StringT>
+    void decode(FieldRef field, StringT &dest) const
+    {
+        dest.clear();
+        decode(field, [&dest] (const char *data, size_t len) { dest.append(data, len); });
+    }
+
+    std::string decode(FieldRef field) const
+    {
+        std::string result;
+        decode(field, result);
+        return result;
+    }
+};
+
+}
+
+#endif /* !STRBO_URL_VIEW_HH */
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_batch.hh"
+#include "bench_common.hh"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/*
+ * Throughput of batch parsing of mixed URLs and of USB URLs only with
+ * increasing numbers of worker threads.
+ */
+
+static std::vector<std::string> make_urls(size_t count, bool usb_only)
+{
+    std::vector<std::string> urls;
+    urls.reserve(count);
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto n = std::to_string(i * 7919);
+
+        switch(usb_only ? i % 2 : i % 4)
+        {
+          case 0:
+            urls.push_back("strbo-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                           "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/"
+                           "Music%2FSome%20Album%2F" + n + "%20-%20Song.flac");
+            break;
+
+          case 1:
+            urls.push_back("strbo-ref-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                           "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/"
+                           "Music%2FSome%20Album/" + n + "%20-%20Song.flac:3");
+            break;
+
+          case 2:
+            urls.push_back("strbo-ref-airable://https%3A%2F%2Fapi.airable.io%2Fradios/"
+                           "https%3A%2F%2Fapi.airable.io%2Fradios%2Fstation%2F" + n + ":7");
+            break;
+
+          case 3:
+            urls.push_back("strbo-trace-airable://https%3A%2F%2Fapi.airable.io%2Fradios/"
+                           "https%3A%2F%2Fapi.airable.io%2Fradios%2Fgenre%2F1:2/"
+                           "https%3A%2F%2Fapi.airable.io%2Fradios%2Fgenre%2F2:5/"
+                           "https%3A%2F%2Fapi.airable.io%2Fradios%2Fstation%2F" + n + ":1");
+            break;
+        }
+    }
+
+    return urls;
+}
+
+static void measure_batch(const char *title, const std::vector<std::string> &urls,
+                          size_t count, unsigned int cores)
+{
+    printf("%s, batch of %zu URLs, %u CPU cores\n", title, urls.size(), cores);
+
+    double single_thread_ns = 0.0;
+
+    for(unsigned int workers = 1; workers <= 2 * cores; workers *= 2)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "  parse(), %u worker%s",
+                 workers, workers == 1 ? "" : "s");
+
+        const double ns = Bench::measure(name, count,
+            [&urls, workers] ()
+            {
+                Bench::sink = StrBoUrl::Batch::parse(urls, workers).size();
+            });
+
+        if(workers == 1)
+            single_thread_ns = ns;
+
+        printf("    %.0f URLs/s, speedup %.2f\n",
+               urls.size() * 1e9 / ns, single_thread_ns / ns);
+    }
+}
+
+int main()
+{
+    const size_t batch_size = 50000;
+    const size_t count = std::max(Bench::iterations(2000) / 200, size_t(1));
+    const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1U);
+
+    measure_batch("Mixed URLs", make_urls(batch_size, false), count, cores);
+
+    /* device and partition names are interned by all workers */
+    measure_batch("USB URLs", make_urls(batch_size, true), count, cores);
+
+    return 0;
+}
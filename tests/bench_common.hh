@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef BENCH_COMMON_HH
+#define BENCH_COMMON_HH
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace Bench
+{
+
+/*!
+ * Sink for benchmark results, keeps the compiler from dropping work.
+ */
+inline volatile size_t sink;
+
+/*!
+ * Number of iterations, may be overridden by \c STRBO_URL_BENCH_ITERATIONS.
+ */
+static inline size_t iterations(size_t default_iterations)
+{
+    const char *env = getenv("STRBO_URL_BENCH_ITERATIONS");
+    return env != nullptr ? strtoul(env, nullptr, 10) : default_iterations;
+}
+
+/*!
+ * Run \p fn \p count times and print the average time per call.
+ */
+template <typename Fn>
+double measure(const char *name, size_t count, Fn &&fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < count; ++i)
+        fn();
+
+    const auto stop = std::chrono::steady_clock::now();
+    const double ns =
+        std::chrono::duration<double, std::nano>(stop - start).count() / count;
+
+    printf("%-56s %10.1f ns/op\n", name, ns);
+
+    return ns;
+}
+
+}
+
+#endif /* !BENCH_COMMON_HH */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_airable.hh"
+#include "bench_common.hh"
+
+#include <vector>
+
+/*
+ * Serialization of Airable location traces of increasing depth, comparing
+ * str() with serialization into reused buffers and with browsing one level
+ * deeper using the kept encoded trace.
+ */
+
+static void make_trace(Airable::LocationTrace &l, size_t depth)
+{
+    l.clear();
+    l.set_reference_point("https://api.airable.io/radios");
+
+    for(size_t i = 0; i < depth; ++i)
+        l.append_to_trace("https://api.airable.io/radios/genre/" + std::to_string(i * 7919),
+                          StrBoUrl::ObjectIndex(i + 1));
+
+    l.set_item("https://api.airable.io/radios/station/1234567", StrBoUrl::ObjectIndex(42));
+}
+
+int main()
+{
+    static const size_t depths[] = { 1, 8, 32, 128 };
+
+    for(const size_t depth : depths)
+    {
+        const size_t count = Bench::iterations(200000) / depth;
+
+        Airable::LocationTrace l;
+        make_trace(l, depth);
+
+        std::string reused;
+        std::vector<char> buffer(l.encoded_length());
+        char name[64];
+
+        printf("Trace depth %zu, %zu bytes\n", depth, l.encoded_length());
+
+        snprintf(name, sizeof(name), "  encoded_length()");
+        Bench::measure(name, count, [&l] () { Bench::sink = l.encoded_length(); });
+
+        snprintf(name, sizeof(name), "  str(), memoized");
+        Bench::measure(name, count, [&l] () { Bench::sink = l.str().length(); });
+
+        snprintf(name, sizeof(name), "  str_into(), reused string");
+        Bench::measure(name, count,
+            [&l, &reused] () { l.str_into(reused); Bench::sink = reused.length(); });
+
+        snprintf(name, sizeof(name), "  write_to(), preallocated buffer");
+        Bench::measure(name, count,
+            [&l, &buffer] () { Bench::sink = l.write_to(buffer.data(), buffer.size()); });
+
+        Airable::LocationTrace nav(l);
+        nav.push_level("https://api.airable.io/radios/genre/0", StrBoUrl::ObjectIndex(1));
+
+        snprintf(name, sizeof(name), "  push_level(), str_into(), pop_level()");
+        Bench::measure(name, count,
+            [&nav, &reused] ()
+            {
+                nav.push_level("https://api.airable.io/radios/genre/1", StrBoUrl::ObjectIndex(2));
+                nav.str_into(reused);
+                nav.pop_level();
+                Bench::sink = reused.length();
+            });
+    }
+
+    return 0;
+}
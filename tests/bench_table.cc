@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_table.hh"
+#include "bench_common.hh"
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Columnar table of USB reference locations compared with a vector of
+ * location objects: appending, scanning, and memory use.
+ */
+
+static std::vector<std::string> make_urls(size_t count)
+{
+    std::vector<std::string> urls;
+    urls.reserve(count);
+
+    for(size_t i = 0; i < count; ++i)
+        urls.push_back("strbo-ref-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                       "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/"
+                       "Music%2FAlbum%20" + std::to_string(i / 12) + "/" +
+                       std::to_string(i % 12 + 1) + "%20-%20Song.flac:" +
+                       std::to_string(i % 12 + 1));
+
+    return urls;
+}
+
+int main()
+{
+    const size_t rows = 20000;
+    const size_t count = std::max(Bench::iterations(1000) / 100, size_t(1));
+    const auto urls(make_urls(rows));
+
+    printf("%zu USB reference locations\n", rows);
+
+    USB::LocationKeyReferenceTable table;
+    std::vector<USB::LocationKeyReference> objects;
+
+    Bench::measure("  append_url() to table", count,
+        [&urls, &table] ()
+        {
+            table.clear();
+
+            for(const auto &url : urls)
+                table.append_url(url);
+
+            Bench::sink = table.size();
+        });
+
+    Bench::measure("  set_url() into vector of objects", count,
+        [&urls, &objects] ()
+        {
+            objects.clear();
+
+            for(const auto &url : urls)
+            {
+                objects.emplace_back();
+                objects.back().try_set_url(url);
+            }
+
+            Bench::sink = objects.size();
+        });
+
+    Bench::measure("  sum of item positions, table", count * 100,
+        [&table] ()
+        {
+            size_t sum = 0;
+
+            for(const uint32_t pos : table.get_item_positions())
+                sum += pos;
+
+            Bench::sink = sum;
+        });
+
+    Bench::measure("  sum of item positions, vector of objects", count * 100,
+        [&objects] ()
+        {
+            size_t sum = 0;
+
+            for(const auto &l : objects)
+                sum += l.unpack().item_position_.get_object_index();
+
+            Bench::sink = sum;
+        });
+
+    size_t object_bytes = objects.capacity() * sizeof(objects[0]);
+
+    for(const auto &l : objects)
+    {
+        const auto &c(l.unpack());
+
+        /* device and partition are shared handles */
+        for(const auto *s : { &c.reference_point_, &c.item_name_ })
+            if(s->capacity() > 15)
+                object_bytes += s->capacity() + 1;
+    }
+
+    printf("  memory: table %zu bytes, vector of objects %zu bytes\n",
+           table.get_memory_usage(), object_bytes);
+
+    return 0;
+}
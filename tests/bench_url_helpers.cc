@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "strbo_url_usb.hh"
+#include "strbo_url_helpers.hh"
+#include "bench_common.hh"
+
+/*
+ * Compares the std::function based helpers with their template counterparts
+ * on the URLs used in the USB unit tests.
+ */
+
+static const char *const usb_urls[] =
+{
+    "strbo-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/Music%2FSome%20Album%2F05%20-%20Song.flac",
+    "strbo-usb://Flash_Disk:usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/",
+    "strbo-usb://My%20USB%20Device:usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/Music%2FSome%20Album%2F05%20-%20Song.flac",
+    "strbo-usb://dev:part/file",
+};
+
+static constexpr size_t number_of_urls = sizeof(usb_urls) / sizeof(usb_urls[0]);
+
+int main()
+{
+    const size_t count = Bench::iterations(200000);
+
+    std::string encoded[number_of_urls];
+    USB::LocationKeySimple::Components decoded[number_of_urls];
+
+    for(size_t i = 0; i < number_of_urls; ++i)
+    {
+        encoded[i] = usb_urls[i];
+
+        USB::LocationKeySimple l;
+        l.set_url(encoded[i]);
+        decoded[i] = l.unpack();
+    }
+
+    const std::function<void(const char *, size_t)> append_fn =
+        [] (const char *, size_t len) { Bench::sink = Bench::sink + len; };
+    const std::function<void(char)> decoded_fn =
+        [] (char ch) { Bench::sink = Bench::sink + ch; };
+    const std::function<void(StrBoUrl::ParseResult::Code, const char *)> error_fn =
+        [] (StrBoUrl::ParseResult::Code, const char *) {};
+
+    Bench::measure("for_each_url_encoded(), std::function", count,
+        [&decoded, &append_fn] ()
+        {
+            for(const auto &c : decoded)
+            {
+                StrBoUrl::for_each_url_encoded(c.device_, append_fn);
+                StrBoUrl::for_each_url_encoded(c.partition_, append_fn);
+                StrBoUrl::for_each_url_encoded(c.path_, append_fn);
+            }
+        });
+
+    Bench::measure("for_each_url_encoded(), template", count,
+        [&decoded] ()
+        {
+            const auto append = [] (const char *, size_t len) { Bench::sink = Bench::sink + len; };
+
+            for(const auto &c : decoded)
+            {
+                StrBoUrl::for_each_url_encoded(c.device_, append);
+                StrBoUrl::for_each_url_encoded(c.partition_, append);
+                StrBoUrl::for_each_url_encoded(c.path_, append);
+            }
+        });
+
+    Bench::measure("for_each_url_decoded(), std::function", count,
+        [&encoded, &decoded_fn, &error_fn] ()
+        {
+            for(const auto &url : encoded)
+                StrBoUrl::for_each_url_decoded(url, decoded_fn, error_fn);
+        });
+
+    Bench::measure("for_each_url_decoded(), template", count,
+        [&encoded] ()
+        {
+            for(const auto &url : encoded)
+                StrBoUrl::for_each_url_decoded(url,
+                    [] (char ch) { Bench::sink = Bench::sink + ch; },
+                    [] (StrBoUrl::ParseResult::Code, const char *) {});
+        });
+
+    Bench::measure("USB::LocationKeySimple::set_url() + str()", count,
+        [&encoded] ()
+        {
+            USB::LocationKeySimple l;
+
+            for(const auto &url : encoded)
+            {
+                l.set_url(url);
+                Bench::sink = Bench::sink + l.str().length();
+            }
+        });
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_batch.hh"
+
+TEST_SUITE_BEGIN("Batch parsing");
+
+static std::vector<std::string> make_urls(size_t count)
+{
+    std::vector<std::string> urls;
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto n = std::to_string(i);
+
+        switch(i % 5)
+        {
+          case 0:
+            urls.push_back("strbo-usb://dev:part/Music%2F" + n + ".flac");
+            break;
+
+          case 1:
+            urls.push_back("strbo-ref-airable://list/item" + n + ":" + std::to_string(i % 7 + 1));
+            break;
+
+          case 2:
+            urls.push_back("strbo-airable://item" + n);
+            break;
+
+          case 3:
+            urls.push_back("strbo-ref-usb://dev:part/ref/item" + n + ":" + std::to_string(i % 7 + 1));
+            break;
+
+          case 4:
+            urls.push_back(i % 2 == 0 ? "strbo-usb://dev:part/a%2G" : "ftp://host/" + n);
+            break;
+        }
+    }
+
+    return urls;
+}
+
+static void check_entries(const std::vector<std::string> &urls,
+                          const std::vector<StrBoUrl::Batch::Entry> &entries)
+{
+    REQUIRE(entries.size() == urls.size());
+
+    for(size_t i = 0; i < urls.size(); ++i)
+    {
+        const auto &e(entries[i]);
+
+        if(i % 5 == 4)
+        {
+            CHECK(e.result_.get_code() ==
+                  (i % 2 == 0
+                   ? StrBoUrl::ParseResult::Code::INVALID_ENCODING
+                   : StrBoUrl::ParseResult::Code::WRONG_SCHEME));
+            CHECK(std::holds_alternative<std::monostate>(e.location_));
+        }
+        else
+        {
+            REQUIRE(e.result_.is_ok());
+            const auto *l = StrBoUrl::get_location(e.location_);
+            REQUIRE(l != nullptr);
+            CHECK(l->str() == urls[i]);
+        }
+    }
+}
+
+TEST_CASE("Small batch is parsed in input order")
+{
+    const auto urls(make_urls(10));
+    check_entries(urls, StrBoUrl::Batch::parse(urls));
+}
+
+TEST_CASE("Large batch is parsed by multiple workers in input order")
+{
+    const auto urls(make_urls(5000));
+    check_entries(urls, StrBoUrl::Batch::parse(urls, 4));
+}
+
+TEST_CASE("Batch of string views is parsed")
+{
+    const auto urls(make_urls(1000));
+    const std::vector<std::string_view> views(urls.begin(), urls.end());
+    check_entries(urls, StrBoUrl::Batch::parse(views, 3));
+}
+
+TEST_CASE("Empty batch yields empty result")
+{
+    CHECK(StrBoUrl::Batch::parse(std::vector<std::string>()).empty());
+}
+
+TEST_CASE("Oversized batch is rejected without touching the URLs")
+{
+    const std::string_view *urls = nullptr;
+    CHECK(StrBoUrl::Batch::parse(urls, size_t(UINT32_MAX) + 1).empty());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_compressed.hh"
+
+TEST_SUITE_BEGIN("Compressed Airable locations");
+
+static const std::string trace_url(
+    "strbo-trace-airable://https%3A%2F%2Fapi.airable.io%2Fradios/"
+    "https%3A%2F%2Fapi.airable.io%2Fradios%2Fgenre%2F1:2:"
+    "https%3A%2F%2Fapi.airable.io%2Fradios%2Fgenre%2F2:5/"
+    "https%3A%2F%2Fapi.airable.io%2Fradios%2Fstation%2F7:1");
+
+TEST_CASE("Longest prefix is found in dictionary")
+{
+    static constexpr std::string_view prefixes[] = { "https://", "https://api.airable.io/" };
+    static constexpr StrBoUrl::PrefixDictionary dict(prefixes);
+
+    CHECK(dict.size() == 2);
+    CHECK(dict.find_longest_prefix("https://api.airable.io/radios") == 2);
+    CHECK(dict.find_longest_prefix("https://example.com/") == 1);
+    CHECK(dict.find_longest_prefix("http://api.airable.io/") == 0);
+    CHECK(dict.find_longest_prefix("https:/") == 0);
+    CHECK(dict.get(2) == "https://api.airable.io/");
+    CHECK(dict.get(0).empty());
+    CHECK(dict.get(3).empty());
+}
+
+TEST_CASE("Airable trace is compressed and expanded")
+{
+    Airable::LocationTrace l;
+    REQUIRE(l.try_set_url(trace_url).is_ok());
+
+    Airable::CompressedLocation cl;
+    cl.set(l);
+    REQUIRE(cl.is_valid());
+    CHECK(cl.get_kind() == Airable::CompressedLocation::Kind::TRACE);
+    CHECK(cl.get_number_of_urls() == 4);
+    CHECK(cl.get_trace_length() == 2);
+    CHECK(cl.get_suffix(1) == "radios/genre/1");
+    CHECK(cl.get_url(1) == "https://api.airable.io/radios/genre/1");
+    CHECK(cl.get_position(2).get_object_index() == 5);
+    CHECK(cl.url_equals(3, "https://api.airable.io/radios/station/7"));
+    CHECK_FALSE(cl.url_equals(3, "https://api.airable.io/radios/station/8"));
+
+    size_t expanded_length = 0;
+    for(size_t i = 0; i < cl.get_number_of_urls(); ++i)
+        expanded_length += cl.get_url(i).length();
+
+    CHECK(cl.get_memory_usage() < expanded_length);
+    CHECK(cl.str() == trace_url);
+
+    Airable::LocationTrace expanded;
+    CHECK(cl.expand(expanded));
+    CHECK(expanded.str() == trace_url);
+
+    Airable::LocationKeySimple wrong_kind;
+    CHECK_FALSE(cl.expand(wrong_kind));
+    CHECK_FALSE(wrong_kind.is_valid());
+}
+
+TEST_CASE("Airable keys are compressed and expanded")
+{
+    Airable::LocationKeyReference ref;
+    ref.set_containing_list("https://api.airable.io/radios");
+    ref.set_item("http://stream.example.com/x", StrBoUrl::ObjectIndex(3));
+
+    Airable::CompressedLocation cl;
+    cl.set(ref);
+    CHECK(cl.get_kind() == Airable::CompressedLocation::Kind::REFERENCE);
+    CHECK(cl.get_suffix(0) == "radios");
+    CHECK(cl.get_suffix(1) == "stream.example.com/x");
+    CHECK(cl.str() == ref.str());
+
+    Airable::LocationKeySimple simple;
+    simple.set_item("no-prefix");
+    cl.set(simple);
+    CHECK(cl.get_kind() == Airable::CompressedLocation::Kind::SIMPLE);
+    CHECK(cl.get_prefix_id(0) == 0);
+    CHECK(cl.str() == simple.str());
+
+    cl.set(Airable::LocationKeySimple());
+    CHECK_FALSE(cl.is_valid());
+    CHECK(cl.str().empty());
+}
+
+TEST_CASE("Compact serialization round trip")
+{
+    Airable::LocationTrace l;
+    REQUIRE(l.try_set_url(trace_url).is_ok());
+
+    Airable::CompressedLocation cl;
+    cl.set(l);
+
+    std::string data;
+    cl.serialize_compact(data);
+    CHECK(data.length() < l.str().length() / 2);
+
+    Airable::CompressedLocation copy;
+    CHECK(copy.try_set_compact(data).is_ok());
+    REQUIRE(copy.is_valid());
+    CHECK(copy.str() == trace_url);
+}
+
+TEST_CASE("Broken compact serializations are rejected")
+{
+    Airable::LocationKeyReference ref;
+    ref.set_containing_list("https://api.airable.io/radios");
+    ref.set_item("https://api.airable.io/radios/1", StrBoUrl::ObjectIndex(3));
+
+    Airable::CompressedLocation cl;
+    cl.set(ref);
+
+    std::string data;
+    cl.serialize_compact(data);
+
+    Airable::CompressedLocation copy;
+
+    const auto truncated(copy.try_set_compact(std::string_view(data).substr(0, data.length() - 1)));
+    CHECK(truncated.get_code() == StrBoUrl::ParseResult::Code::TRUNCATED_ENCODING);
+    CHECK_FALSE(copy.is_valid());
+    CHECK(copy.get_number_of_urls() == 0);
+
+    const auto junk(copy.try_set_compact(data + "x"));
+    CHECK(junk.get_code() == StrBoUrl::ParseResult::Code::TRAILING_JUNK);
+    CHECK(junk.get_offset() == data.length());
+
+    std::string bad_prefix(data);
+    bad_prefix[2] = char(200);
+    CHECK(copy.try_set_compact(bad_prefix).get_code() == StrBoUrl::ParseResult::Code::OUT_OF_RANGE);
+
+    std::string no_position(data);
+    no_position.back() = 0;
+    const auto pos(copy.try_set_compact(no_position));
+    CHECK(pos.get_code() == StrBoUrl::ParseResult::Code::OUT_OF_RANGE);
+    CHECK(pos.get_component() == StrBoUrl::ParseResult::Component::ITEM_POSITION);
+
+    /* position 3 in five bytes, with bits beyond 32 bits set */
+    std::string wrapped_position(data);
+    wrapped_position.back() = char(0x83);
+    wrapped_position.append("\x80\x80\x80\x10");
+    CHECK(copy.try_set_compact(wrapped_position).get_code() ==
+          StrBoUrl::ParseResult::Code::TRUNCATED_ENCODING);
+
+    std::string long_position(data);
+    long_position.back() = char(0x83);
+    long_position.append("\x80\x80\x80\x00", 4);
+    CHECK(copy.try_set_compact(long_position).is_ok());
+    CHECK(copy.get_position(1).get_object_index() == 3);
+
+    CHECK(copy.try_set_compact(data).is_ok());
+    CHECK(copy.str() == ref.str());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_usb.hh"
+#include "strbo_url_airable.hh"
+
+#include <unordered_set>
+
+TEST_SUITE_BEGIN("Hashing and comparing locations");
+
+TEST_CASE("Location hash equals hash of its URL")
+{
+    const std::string url("strbo-ref-usb://My%20Stick:usb-0%3A0-part1/some%2Fdir/item:7");
+
+    USB::LocationKeyReference l;
+    REQUIRE(l.try_set_url(url).is_ok());
+
+    const size_t h = l.hash();
+    CHECK(h == StrBoUrl::hash_url(url));
+    CHECK(std::hash<USB::LocationKeyReference>()(l) == h);
+    CHECK(StrBoUrl::LocationHash()(url) == h);
+
+    /* same result from the memoized URL */
+    CHECK(l.str() == url);
+    CHECK(l.hash() == h);
+
+    CHECK(USB::LocationKeyReference().hash() == StrBoUrl::hash_url(""));
+}
+
+TEST_CASE("Airable trace hash is computed with and without kept encoded trace")
+{
+    const std::string url("strbo-trace-airable://ref/a%2F1:2:b:3/item:5");
+
+    Airable::LocationTrace parsed;
+    REQUIRE(parsed.try_set_url(url).is_ok());
+
+    Airable::LocationTrace built;
+    built.set_reference_point("ref");
+    built.push_level("a/1", StrBoUrl::ObjectIndex(2));
+    built.push_level("b", StrBoUrl::ObjectIndex(3));
+    built.set_item("item", StrBoUrl::ObjectIndex(5));
+
+    CHECK(parsed == built);
+    CHECK(parsed.hash() == StrBoUrl::hash_url(url));
+    CHECK(built.hash() == StrBoUrl::hash_url(url));
+    CHECK(parsed.hash_ignoring_positions() == built.hash_ignoring_positions());
+}
+
+TEST_CASE("Position hints are ignored on request")
+{
+    Airable::LocationKeyReference a;
+    REQUIRE(a.try_set_url("strbo-ref-airable://list/item:3").is_ok());
+    Airable::LocationKeyReference b;
+    REQUIRE(b.try_set_url("strbo-ref-airable://list/item:4").is_ok());
+    Airable::LocationKeyReference c;
+    REQUIRE(c.try_set_url("strbo-ref-airable://list/other:3").is_ok());
+
+    CHECK(a != b);
+    CHECK(a.equals_ignoring_positions(b));
+    CHECK(a.hash() != b.hash());
+    CHECK(a.hash_ignoring_positions() == b.hash_ignoring_positions());
+
+    CHECK(a != c);
+    CHECK_FALSE(a.equals_ignoring_positions(c));
+
+    USB::LocationTrace t1;
+    REQUIRE(t1.try_set_url("strbo-trace-usb://dev:part/ref/x/y:1").is_ok());
+    USB::LocationTrace t2;
+    REQUIRE(t2.try_set_url("strbo-trace-usb://dev:part/ref/x/y:9").is_ok());
+    CHECK(t1 != t2);
+    CHECK(t1.equals_ignoring_positions(t2));
+    CHECK(t1.hash_ignoring_positions() == t2.hash_ignoring_positions());
+}
+
+TEST_CASE("Locations are compared with URLs without generating them")
+{
+    USB::LocationKeySimple l;
+    REQUIRE(l.try_set_url("strbo-usb://dev:part/a%20b").is_ok());
+
+    CHECK(l.equals_url("strbo-usb://dev:part/a%20b"));
+    CHECK_FALSE(l.equals_url("strbo-usb://dev:part/a%20"));
+    CHECK_FALSE(l.equals_url("strbo-usb://dev:part/a%20bc"));
+    CHECK_FALSE(l.equals_url("strbo-usb://dev:part/a b"));
+    CHECK(USB::LocationKeySimple().equals_url(""));
+
+    USB::LocationKeySimple other;
+    other.set_device("dev");
+    other.set_partition("part");
+    other.set_path("a b");
+    CHECK(l == other);
+    other.set_path("a c");
+    CHECK(l != other);
+}
+
+TEST_CASE("Locations are used as keys in unordered sets")
+{
+    std::unordered_set<Airable::LocationKeySimple> set;
+    Airable::LocationKeySimple l;
+
+    l.set_item("https://api.airable.io/radios/1");
+    set.insert(l);
+    l.set_item("https://api.airable.io/radios/2");
+    set.insert(l);
+    set.insert(l);
+    CHECK(set.size() == 2);
+    CHECK(set.count(l) == 1);
+
+    std::unordered_set<USB::pmr::LocationKeySimple, StrBoUrl::LocationHash, StrBoUrl::LocationEqual> pmr_set;
+    USB::pmr::LocationKeySimple p;
+    p.set_device("dev");
+    p.set_partition("part");
+    p.set_path("file");
+    pmr_set.insert(p);
+    CHECK(pmr_set.count(p) == 1);
+    CHECK(StrBoUrl::LocationEqual()(p, "strbo-usb://dev:part/file"));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_table.hh"
+
+TEST_SUITE_BEGIN("Location tables");
+
+TEST_CASE("USB reference table stores components in columns")
+{
+    USB::LocationKeyReferenceTable table;
+    CHECK(table.empty());
+
+    CHECK(table.append_url("strbo-ref-usb://dev:part/Music/Song%201.flac:5").is_ok());
+    CHECK(table.append_url("strbo-ref-usb://dev:part/Music/Song%202.flac:").failed());
+    CHECK(table.append_url("strbo-ref-usb://My%20Stick:p1/%2F/Other.mp3:1").is_ok());
+
+    USB::LocationKeyReference l;
+    CHECK(l.set_url("strbo-ref-usb://d:p/ref/item:4294967295") == nullptr);
+    CHECK(table.append(l));
+    CHECK_FALSE(table.append(USB::LocationKeyReference()));
+
+    REQUIRE(table.size() == 3);
+    CHECK(table.get_device(0) == "dev");
+    CHECK(table.get_partition(0) == "part");
+    CHECK(table.get_reference_point(0) == "Music");
+    CHECK(table.get_item_name(0) == "Song 1.flac");
+    CHECK(table.get_item_position(0).get_object_index() == 5);
+    CHECK(table.get_device(1) == "My Stick");
+    CHECK(table.get_reference_point(1) == "/");
+    CHECK(table.get_item_name(1) == "Other.mp3");
+    CHECK(table.get_item_name(2) == "item");
+    CHECK(table.get_item_positions() == std::vector<uint32_t>({5, 1, 4294967295U}));
+
+    USB::LocationKeyReference copy;
+    table.get(2, copy);
+    CHECK(copy.str() == l.str());
+
+    table.clear();
+    CHECK(table.empty());
+}
+
+TEST_CASE("USB simple table with empty components")
+{
+    USB::LocationKeySimpleTable table;
+    CHECK(table.append_url("strbo-usb://dev:part/").is_ok());
+    CHECK(table.append_url("strbo-usb://dev2:part2/a%2Fb").is_ok());
+
+    REQUIRE(table.size() == 2);
+    CHECK(table.get_path(0).empty());
+    CHECK(table.get_device(1) == "dev2");
+    CHECK(table.get_path(1) == "a/b");
+
+    USB::LocationKeySimple l;
+    table.get(0, l);
+    CHECK(l.str() == "strbo-usb://dev:part/");
+}
+
+TEST_CASE("Airable trace table stores trace levels in columns")
+{
+    const std::string with_levels("strbo-trace-airable://ref/level1:2:level%202:3/item:4");
+    const std::string no_levels("strbo-trace-airable://ref2/item2:1");
+
+    Airable::LocationTraceTable table;
+    CHECK(table.append_url(with_levels).is_ok());
+    CHECK(table.append_url(no_levels).is_ok());
+
+    Airable::LocationTrace l;
+    CHECK(l.set_url(with_levels) == nullptr);
+    CHECK(table.append(l));
+
+    REQUIRE(table.size() == 3);
+    CHECK(table.get_reference_point(0) == "ref");
+    CHECK(table.get_item(0) == "item");
+    CHECK(table.get_item_position(0).get_object_index() == 4);
+    REQUIRE(table.get_trace_length(0) == 2);
+    CHECK(table.get_trace_url(0, 0) == "level1");
+    CHECK(table.get_trace_position(0, 0).get_object_index() == 2);
+    CHECK(table.get_trace_url(0, 1) == "level 2");
+    CHECK(table.get_trace_position(0, 1).get_object_index() == 3);
+
+    CHECK(table.get_trace_length(1) == 0);
+    CHECK(table.get_item(1) == "item2");
+
+    CHECK(table.get_trace_length(2) == 2);
+    CHECK(table.get_trace_url(2, 1) == "level 2");
+
+    Airable::LocationTrace copy;
+    table.get(0, copy);
+    CHECK(copy.str() == with_levels);
+    table.get(1, copy);
+    CHECK(copy.str() == no_levels);
+}
+
+TEST_CASE("Table uses less memory than vector of objects")
+{
+    USB::LocationKeyReferenceTable table;
+    std::vector<USB::LocationKeyReference> objects;
+
+    for(size_t i = 0; i < 1000; ++i)
+    {
+        const auto url("strbo-ref-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                       "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/"
+                       "Music%2FSome%20Album/" + std::to_string(i) + ".flac:1");
+        REQUIRE(table.append_url(url).is_ok());
+        objects.emplace_back();
+        REQUIRE(objects.back().set_url(url) == nullptr);
+    }
+
+    /* not even counting the heap allocations made by the objects */
+    CHECK(table.get_memory_usage() * 2 < objects.capacity() * sizeof(objects[0]));
+}
+
+TEST_SUITE_END();
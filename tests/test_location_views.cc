@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_usb.hh"
+#include "strbo_url_airable.hh"
+
+#include <cstring>
+#include <sys/mman.h>
+
+TEST_SUITE_BEGIN("Location views");
+
+TEST_CASE("Views are small")
+{
+    CHECK(sizeof(USB::LocationKeySimpleView) <= 40);
+    CHECK(sizeof(USB::LocationTraceView) <= 56);
+    CHECK(sizeof(Airable::LocationTraceView) <= 48);
+}
+
+TEST_CASE("Empty view is invalid")
+{
+    USB::LocationKeySimpleView view;
+    CHECK_FALSE(view.is_valid());
+    CHECK(view.get_url().empty());
+}
+
+TEST_CASE("Set USB view from URL and decode components on demand")
+{
+    const std::string url("strbo-usb://My%20Device:part1/Music%2FSome%20Album%2F05.flac");
+
+    USB::LocationKeySimpleView view;
+    CHECK(view.try_set_url(url).is_ok());
+    REQUIRE(view.is_valid());
+    CHECK(view.get_url().data() == url.data());
+    CHECK(view.raw(view.get_device()) == "My%20Device");
+    CHECK(view.decode(view.get_device()) == "My Device");
+    CHECK(view.raw(view.get_partition()) == "part1");
+
+    std::string path;
+    view.decode(view.get_path(),
+                [&path] (const char *data, size_t len) { path.append(data, len); });
+    CHECK(path == "Music/Some Album/05.flac");
+}
+
+TEST_CASE("View of USB reference key is convertible to owning object")
+{
+    const std::string url("strbo-ref-usb://dev:part/Music%2FAlbum/Song.flac:5");
+
+    USB::LocationKeyReferenceView view;
+    CHECK(view.try_set_url(url).is_ok());
+    REQUIRE(view.is_valid());
+    CHECK(view.get_item_position().get_object_index() == 5);
+
+    USB::LocationKeyReference location(view);
+    REQUIRE(location.is_valid());
+    CHECK(location.str() == url);
+    CHECK(location.unpack().reference_point_ == "Music/Album");
+}
+
+TEST_CASE("USB view reports parsing errors and is cleared")
+{
+    USB::LocationTraceView view;
+    CHECK(view.try_set_url("strbo-trace-usb://dev:part/a/b:1").is_ok());
+    REQUIRE(view.is_valid());
+
+    const auto wrong_scheme(view.try_set_url("strbo-usb://dev:part/a"));
+    CHECK(wrong_scheme.get_code() == StrBoUrl::ParseResult::Code::WRONG_SCHEME);
+    CHECK(view.is_valid());
+
+    const auto result(view.try_set_url("strbo-trace-usb://dev:part/a/b%4:1"));
+    CHECK(result.get_code() == StrBoUrl::ParseResult::Code::TRUNCATED_ENCODING);
+    CHECK(result.get_component() == StrBoUrl::ParseResult::Component::ITEM_NAME);
+    CHECK(result.get_offset() == 30);
+    CHECK_FALSE(view.is_valid());
+}
+
+TEST_CASE("URLs of 4 GiB or more are rejected")
+{
+    /* sparse mapping, only the first page is ever touched */
+    const size_t length = size_t(UINT32_MAX) + 1;
+    void *mem = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    REQUIRE(mem != MAP_FAILED);
+
+    static const char prefix[] = "strbo-usb://dev:part/";
+    memcpy(mem, prefix, sizeof(prefix) - 1);
+    const std::string_view url(static_cast<const char *>(mem), length);
+
+    USB::LocationKeySimpleView view;
+    CHECK(view.try_set_url(url).get_code() == StrBoUrl::ParseResult::Code::OUT_OF_RANGE);
+    CHECK_FALSE(view.is_valid());
+
+    USB::LocationKeySimple l;
+    CHECK(l.try_set_url(url).get_code() == StrBoUrl::ParseResult::Code::OUT_OF_RANGE);
+
+    munmap(mem, length);
+}
+
+TEST_CASE("Explicit root reference point is dropped by USB trace view")
+{
+    USB::LocationTraceView view;
+    const auto result(view.try_set_url("strbo-trace-usb://dev:part/%2F/item:1"));
+    CHECK(result.is_ok());
+    CHECK(result.get_warning() != nullptr);
+    REQUIRE(view.is_valid());
+    CHECK(view.get_reference_point().empty());
+    CHECK(view.decode(view.get_item_name()) == "item");
+}
+
+TEST_CASE("Set Airable simple view from URL")
+{
+    Airable::LocationKeySimpleView view;
+    CHECK(view.try_set_url("strbo-airable://https%3A%2F%2Fairable.io%2Fid%2F1").is_ok());
+    REQUIRE(view.is_valid());
+    CHECK(view.decode(view.get_item()) == "https://airable.io/id/1");
+
+    Airable::LocationKeySimple location(view);
+    CHECK(location.unpack().item_url_ == "https://airable.io/id/1");
+}
+
+TEST_CASE("Set Airable reference view from URL")
+{
+    Airable::LocationKeyReferenceView view;
+    CHECK(view.try_set_url("strbo-ref-airable://list%2F1/item%2F2:7").is_ok());
+    REQUIRE(view.is_valid());
+    CHECK(view.decode(view.get_containing_list()) == "list/1");
+    CHECK(view.decode(view.get_item()) == "item/2");
+    CHECK(view.get_item_position().get_object_index() == 7);
+}
+
+TEST_CASE("Airable trace view enumerates trace levels")
+{
+    const std::string url("strbo-trace-airable://ref/a%2F1:2:b:3:c:4/item:5");
+
+    Airable::LocationTraceView view;
+    CHECK(view.try_set_url(url).is_ok());
+    REQUIRE(view.is_valid());
+    CHECK(view.get_trace_length() == 3);
+
+    std::vector<std::pair<std::string, uint32_t>> levels;
+    view.for_each_trace_level(
+        [&view, &levels] (StrBoUrl::FieldRef level, StrBoUrl::ObjectIndex position)
+        {
+            levels.emplace_back(view.decode(level), position.get_object_index());
+        });
+
+    REQUIRE(levels.size() == 3);
+    CHECK(levels[0].first == "a/1");
+    CHECK(levels[0].second == 2);
+    CHECK(levels[1].first == "b");
+    CHECK(levels[1].second == 3);
+    CHECK(levels[2].first == "c");
+    CHECK(levels[2].second == 4);
+
+    Airable::LocationTrace location(view);
+    REQUIRE(location.is_valid());
+    CHECK(location.str() == url);
+}
+
+TEST_CASE("Airable trace levels are accessible by index")
+{
+    Airable::LocationTrace location;
+    CHECK(location.try_set_url("strbo-trace-airable://ref/a%2F1:2:b:3:c:4/item:5").is_ok());
+    REQUIRE(location.is_valid());
+    REQUIRE(location.get_trace_length() == 3);
+    CHECK(location.get_trace_url(0) == "a/1");
+    CHECK(location.get_trace_position(0).get_object_index() == 2);
+    CHECK(location.get_trace_url(2) == "c");
+    CHECK(location.get_trace_position(2).get_object_index() == 4);
+
+    location.append_to_trace("d:e", StrBoUrl::ObjectIndex(6));
+    REQUIRE(location.get_trace_length() == 4);
+    CHECK(location.get_trace_url(3) == "d:e");
+    CHECK(location.get_trace_url(2) == "c");
+    CHECK(location.str() == "strbo-trace-airable://ref/a%2F1:2:b:3:c:4:d%3Ae:6/item:5");
+}
+
+TEST_CASE("Airable trace is navigated by pushing and popping levels")
+{
+    Airable::LocationTrace location;
+    location.set_reference_point("r/1");
+    location.set_item("item", StrBoUrl::ObjectIndex(5));
+    CHECK(location.get_encoded_trace().empty());
+    CHECK_FALSE(location.pop_level());
+
+    location.push_level("a/1", StrBoUrl::ObjectIndex(2));
+    CHECK(location.get_encoded_trace() == "r%2F1/a%2F1:2");
+    location.push_level("b", StrBoUrl::ObjectIndex(3));
+    CHECK(location.str() == "strbo-trace-airable://r%2F1/a%2F1:2:b:3/item:5");
+
+    CHECK(location.pop_level());
+    CHECK(location.get_trace_length() == 1);
+    CHECK(location.str() == "strbo-trace-airable://r%2F1/a%2F1:2/item:5");
+
+    location.append_to_trace("c", StrBoUrl::ObjectIndex(4));
+    CHECK(location.get_encoded_trace() == "r%2F1/a%2F1:2:c:4");
+
+    CHECK(location.pop_level());
+    CHECK(location.pop_level());
+    CHECK_FALSE(location.pop_level());
+    CHECK(location.get_encoded_trace() == "r%2F1");
+    CHECK(location.str() == "strbo-trace-airable://r%2F1/item:5");
+
+    location.set_reference_point("s");
+    CHECK(location.get_encoded_trace().empty());
+    location.push_level("x", StrBoUrl::ObjectIndex(1));
+    CHECK(location.str() == "strbo-trace-airable://s/x:1/item:5");
+
+    Airable::LocationTrace parsed;
+    CHECK(parsed.try_set_url("strbo-trace-airable://ref/a:2/item:5").is_ok());
+    parsed.push_level("b", StrBoUrl::ObjectIndex(3));
+    CHECK(parsed.str() == "strbo-trace-airable://ref/a:2:b:3/item:5");
+    CHECK(parsed.try_set_url("strbo-trace-airable://ref/item:5").is_ok());
+    CHECK(parsed.get_encoded_trace().empty());
+}
+
+TEST_CASE("Airable trace view rejects invalid trace positions")
+{
+    Airable::LocationTraceView view;
+
+    const auto junk(view.try_set_url("strbo-trace-airable://ref/a:x/item:3"));
+    CHECK(junk.get_code() == StrBoUrl::ParseResult::Code::TRAILING_JUNK);
+    CHECK(junk.get_component() == StrBoUrl::ParseResult::Component::TRACE_ITEM_POSITION);
+    CHECK(junk.get_offset() == 28);
+
+    const auto zero(view.try_set_url("strbo-trace-airable://ref/a:0:b:1/item:3"));
+    CHECK(zero.get_code() == StrBoUrl::ParseResult::Code::OUT_OF_RANGE);
+    CHECK(zero.get_offset() == 28);
+    CHECK_FALSE(view.is_valid());
+}
+
+TEST_CASE("Airable trace view without trace")
+{
+    Airable::LocationTraceView view;
+    CHECK(view.try_set_url("strbo-trace-airable://ref/item:5").is_ok());
+    REQUIRE(view.is_valid());
+    CHECK(view.get_trace_length() == 0);
+    CHECK(view.decode(view.get_item()) == "item");
+}
+
+TEST_SUITE_END();
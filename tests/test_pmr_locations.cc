@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_usb.hh"
+#include "strbo_url_airable.hh"
+
+TEST_SUITE_BEGIN("Locations with memory resources");
+
+/*!
+ * Test fixture: arena which fails on exhaustion, and which is also the
+ * default resource so that any allocation outside the arena fails, too.
+ */
+class ArenaFixture
+{
+  private:
+    char buffer_[8192];
+    std::pmr::memory_resource *previous_default_;
+
+  protected:
+    std::pmr::monotonic_buffer_resource arena_;
+
+  public:
+    explicit ArenaFixture():
+        previous_default_(std::pmr::set_default_resource(std::pmr::null_memory_resource())),
+        arena_(buffer_, sizeof(buffer_), std::pmr::null_memory_resource())
+    {}
+
+    ~ArenaFixture() { std::pmr::set_default_resource(previous_default_); }
+};
+
+TEST_CASE_FIXTURE(ArenaFixture, "Parse USB location into arena")
+{
+    const std::string_view url("strbo-ref-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                               "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/"
+                               "Music%2FSome%20Album/05%20-%20Song.flac:5");
+
+    USB::pmr::LocationKeyReference l(&arena_);
+    CHECK(l.try_set_url(url).is_ok());
+    REQUIRE(l.is_valid());
+
+    const auto &c(l.unpack());
+    CHECK(c.device_ == "usb-Generic_Flash_Disk_1EB86759-0:0");
+    CHECK(c.reference_point_ == "Music/Some Album");
+    CHECK(c.item_name_ == "05 - Song.flac");
+    CHECK(c.device_.get_allocator().resource() == &arena_);
+
+    char out[256];
+    REQUIRE(l.write_to(out, sizeof(out)) == url.length());
+    CHECK(std::string_view(out, url.length()) == url);
+}
+
+TEST_CASE_FIXTURE(ArenaFixture, "Parse Airable traces into arena")
+{
+    const std::string_view url("strbo-trace-airable://https%3A%2F%2Fapi.airable.io%2Fradios/"
+                               "https%3A%2F%2Fapi.airable.io%2Fradios%2Fgenre%2F1:2:"
+                               "https%3A%2F%2Fapi.airable.io%2Fradios%2Fgenre%2F2:5/"
+                               "https%3A%2F%2Fapi.airable.io%2Fradios%2Fstation%2F7:1");
+
+    for(int i = 0; i < 3; ++i)
+    {
+        Airable::pmr::LocationTrace l(&arena_);
+        CHECK(l.try_set_url(url).is_ok());
+        REQUIRE(l.is_valid());
+
+        const auto &c(l.unpack());
+        REQUIRE(c.trace_urls_.size() == 2);
+        CHECK(c.trace_urls_[1].first == "https://api.airable.io/radios/genre/2");
+        CHECK(c.trace_urls_.get_allocator().resource() == &arena_);
+        CHECK(c.item_url_ == "https://api.airable.io/radios/station/7");
+    }
+}
+
+TEST_CASE_FIXTURE(ArenaFixture, "Set components of arena location")
+{
+    Airable::pmr::LocationKeyReference l(&arena_);
+    l.set_containing_list("https://api.airable.io/radios");
+    l.set_item("https://api.airable.io/radios/station/7", StrBoUrl::ObjectIndex(3));
+    REQUIRE(l.is_valid());
+    CHECK(l.unpack().item_url_.get_allocator().resource() == &arena_);
+}
+
+TEST_CASE_FIXTURE(ArenaFixture, "URL representation of arena location is memoized in arena")
+{
+    const std::string_view url("strbo-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                               "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/Music");
+
+    USB::pmr::LocationKeySimple l(&arena_);
+    CHECK(l.try_set_url(url).is_ok());
+    REQUIRE(l.is_valid());
+
+    const std::pmr::string &s(l.str());
+    CHECK(s == url);
+    CHECK(s.get_allocator().resource() == &arena_);
+    CHECK(&l.str() == &s);
+
+    USB::pmr::LocationKeySimple moved(std::move(l));
+    CHECK(&moved.str() == &s);
+
+    moved.append_to_path("Some Album");
+    CHECK(moved.str() == "strbo-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:"
+                         "usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/Music%2FSome%20Album");
+    CHECK(static_cast<const StrBoUrl::Location &>(moved).str() == moved.str());
+}
+
+TEST_SUITE_END();
@@ -43,7 +43,7 @@ class SimpleResourceLocatorFixture
     class Locator: public StrBoUrl::Schema::ResourceLocatorSimple
     {
       public:
-        explicit Locator():
+        constexpr explicit Locator():
             StrBoUrl::Schema::ResourceLocatorSimple("testing-simple")
         {}
     };
@@ -57,6 +57,14 @@ TEST_CASE_FIXTURE(SimpleResourceLocatorFixture, "Retrieve scheme name")
     CHECK(locator_.get_scheme_name() == "testing-simple");
 }
 
+TEST_CASE("Scheme objects are constant expressions")
+{
+    static constexpr SimpleResourceLocatorFixture::Locator locator;
+    static_assert(locator.get_scheme_name() == "testing-simple");
+    static_assert(locator.get_scheme_name().length() == 14);
+    CHECK(locator.url_matches_scheme("testing-simple://"));
+}
+
 TEST_CASE_FIXTURE(SimpleResourceLocatorFixture, "URL with matching scheme name")
 {
     CHECK(locator_.url_matches_scheme("testing-simple://"));
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_registry.hh"
+
+#include <vector>
+
+TEST_SUITE_BEGIN("Scheme registry");
+
+using StrBoUrl::Registry::SchemeId;
+
+TEST_CASE("Schemes are identified by name")
+{
+    CHECK(StrBoUrl::Registry::identify("strbo-usb://dev:part/") == SchemeId::USB_SIMPLE);
+    CHECK(StrBoUrl::Registry::identify("strbo-ref-usb://d:p/r/i:1") == SchemeId::USB_REFERENCE);
+    CHECK(StrBoUrl::Registry::identify("strbo-trace-usb://x") == SchemeId::USB_TRACE);
+    CHECK(StrBoUrl::Registry::identify("strbo-airable://x") == SchemeId::AIRABLE_SIMPLE);
+    CHECK(StrBoUrl::Registry::identify("strbo-ref-airable://x") == SchemeId::AIRABLE_REFERENCE);
+    CHECK(StrBoUrl::Registry::identify("strbo-trace-airable://x") == SchemeId::AIRABLE_TRACE);
+    CHECK(StrBoUrl::Registry::identify("http://example.com") == SchemeId::HTTP);
+    CHECK(StrBoUrl::Registry::identify("https://example.com") == SchemeId::HTTPS);
+}
+
+TEST_CASE("Unknown and malformed schemes are not identified")
+{
+    CHECK(StrBoUrl::Registry::identify("") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify(std::string_view()) == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("strbo-usb") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("strbo-usb:") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("strbo-usb:/dev") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("strbo-usx://dev") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("strbo-ref-xyz://a") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("ftp://example.com") == SchemeId::UNKNOWN);
+    CHECK(StrBoUrl::Registry::identify("strbo-trace-airable-x://a") == SchemeId::UNKNOWN);
+}
+
+TEST_CASE("Registered scheme objects match the location classes")
+{
+    CHECK(StrBoUrl::Registry::get_scheme(SchemeId::UNKNOWN) == nullptr);
+    CHECK(StrBoUrl::Registry::get_scheme(SchemeId::USB_TRACE) == &USB::LocationTrace::get_scheme());
+    CHECK(StrBoUrl::Registry::get_scheme(SchemeId::AIRABLE_SIMPLE) == &Airable::LocationKeySimple::get_scheme());
+    REQUIRE(StrBoUrl::Registry::get_scheme(SchemeId::HTTPS) != nullptr);
+    CHECK(StrBoUrl::Registry::get_scheme(SchemeId::HTTPS)->get_scheme_name() == "https");
+}
+
+TEST_CASE("Parse any known URL into matching location object")
+{
+    StrBoUrl::ParseResult result;
+    const std::string url("strbo-ref-usb://dev:part/Music/Song.flac:5");
+
+    auto location = StrBoUrl::Registry::parse_any(url, result);
+    CHECK(result.is_ok());
+    REQUIRE(location != nullptr);
+    CHECK(dynamic_cast<USB::LocationKeyReference *>(location.get()) != nullptr);
+    CHECK(location->str() == url);
+}
+
+TEST_CASE("Parsing unknown or malformed URLs yields no location object")
+{
+    StrBoUrl::ParseResult result;
+
+    CHECK(StrBoUrl::Registry::parse_any("http://example.com", result) == nullptr);
+    CHECK(result.get_code() == StrBoUrl::ParseResult::Code::WRONG_SCHEME);
+
+    CHECK(StrBoUrl::Registry::parse_any("strbo-airable://a%2Gb", result) == nullptr);
+    CHECK(result.get_code() == StrBoUrl::ParseResult::Code::INVALID_ENCODING);
+}
+
+TEST_CASE("Heterogeneous locations are stored by value")
+{
+    const std::vector<std::string> urls
+    {
+        "strbo-usb://dev:part/Music%2FSong.flac",
+        "strbo-airable://item",
+        "strbo-ref-airable://list/item:3",
+        "ftp://example.com/",
+    };
+
+    std::vector<StrBoUrl::AnyLocation> locations(urls.size());
+
+    for(size_t i = 0; i < urls.size(); ++i)
+        StrBoUrl::Registry::parse_any(urls[i], locations[i]);
+
+    CHECK(std::holds_alternative<USB::LocationKeySimple>(locations[0]));
+    CHECK(std::holds_alternative<Airable::LocationKeySimple>(locations[1]));
+    CHECK(std::holds_alternative<Airable::LocationKeyReference>(locations[2]));
+    CHECK(std::holds_alternative<std::monostate>(locations[3]));
+    CHECK(StrBoUrl::get_location(locations[3]) == nullptr);
+
+    const auto copy(locations);
+
+    for(size_t i = 0; i < 3; ++i)
+    {
+        const auto *l = StrBoUrl::get_location(copy[i]);
+        REQUIRE(l != nullptr);
+        CHECK(l->str() == urls[i]);
+        CHECK(std::visit([] (const auto &loc) -> std::string
+                         {
+                             if constexpr(std::is_same_v<std::decay_t<decltype(loc)>, std::monostate>)
+                                 return "";
+                             else
+                                 return loc.str();
+                         }, copy[i]) == urls[i]);
+    }
+}
+
+TEST_SUITE_END();
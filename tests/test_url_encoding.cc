@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url.hh"
+#include "strbo_url_helpers.hh"
+
+TEST_SUITE_BEGIN("URL encoding and decoding");
+
+static std::string encode(const std::string &src)
+{
+    std::string result;
+    StrBoUrl::for_each_url_encoded(src,
+        [&result] (const char *enc, size_t len) { result.append(enc, len); });
+    return result;
+}
+
+/*
+ * Straightforward reference implementation, one byte at a time.
+ */
+static std::string encode_reference(const std::string &src)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string result;
+
+    for(const char ch : src)
+    {
+        if(StrBoUrl::Location::safe_characters.find(ch) != std::string::npos)
+            result += ch;
+        else
+        {
+            const auto byte = static_cast<uint8_t>(ch);
+            result += '%';
+            result += hex[byte >> 4];
+            result += hex[byte & 0x0f];
+        }
+    }
+
+    return result;
+}
+
+TEST_CASE("Safe characters are not encoded")
+{
+    CHECK(encode(std::string(StrBoUrl::Location::safe_characters)) == StrBoUrl::Location::safe_characters);
+}
+
+TEST_CASE("Empty string is encoded as empty string")
+{
+    CHECK(encode("").empty());
+}
+
+TEST_CASE("Reserved characters are encoded")
+{
+    CHECK(encode("Music/Some Album:05") == "Music%2FSome%20Album%3A05");
+    CHECK(encode("%") == "%25");
+}
+
+TEST_CASE("UTF-8 characters are encoded byte by byte")
+{
+    CHECK(encode("Caf\xc3\xa9") == "Caf%C3%A9");
+    CHECK(encode("\xff\x80\x7f") == "%FF%80%7F");
+}
+
+TEST_CASE("Each byte value is encoded like the reference implementation")
+{
+    for(unsigned int i = 0; i < 256; ++i)
+    {
+        /* place byte at each position of a vector-sized block */
+        for(size_t pos = 0; pos < 40; ++pos)
+        {
+            std::string src(40, 'a');
+            src[pos] = static_cast<char>(i);
+            CHECK(encode(src) == encode_reference(src));
+        }
+    }
+}
+
+TEST_CASE("Long runs of unsafe characters are encoded like the reference implementation")
+{
+    std::string src;
+
+    for(unsigned int i = 0; i < 1000; ++i)
+        src += static_cast<char>((i * 7) % 256);
+
+    CHECK(encode(src) == encode_reference(src));
+}
+
+TEST_CASE("Encoding into exactly sized buffer matches the reference implementation")
+{
+    for(unsigned int i = 0; i < 256; ++i)
+    {
+        for(size_t pos = 0; pos < 40; pos += 3)
+        {
+            std::string src(40, 'a');
+            src[pos] = static_cast<char>(i);
+
+            const auto expected(encode_reference(src));
+            CHECK(StrBoUrl::Encoding::encoded_length(src.data(), src.length()) == expected.length());
+
+            std::string out(expected.length(), '\0');
+            CHECK(StrBoUrl::Encoding::encode_into(src.data(), src.length(), &out[0]) ==
+                  out.data() + out.length());
+            CHECK(out == expected);
+        }
+    }
+}
+
+static std::string decode(const std::string &src)
+{
+    std::string result("junk");
+    CHECK(StrBoUrl::url_decode(src.data(), src.length(), result,
+                               [] (StrBoUrl::ParseResult::Code code, const char *)
+                               {
+                                   FAIL(StrBoUrl::ParseResult::get_message(code));
+                               }));
+    return result;
+}
+
+struct DecodeError
+{
+    StrBoUrl::ParseResult::Code code_ = StrBoUrl::ParseResult::Code::OK;
+    size_t offset_ = 0;
+};
+
+static std::string decode_with_error(const std::string &src, DecodeError &error)
+{
+    std::string result;
+    CHECK_FALSE(StrBoUrl::url_decode(src.data(), src.length(), result,
+                                     [&src, &error]
+                                     (StrBoUrl::ParseResult::Code code, const char *where)
+                                     {
+                                         error.code_ = code;
+                                         error.offset_ = where - src.data();
+                                     }));
+    return result;
+}
+
+TEST_CASE("Empty string is decoded as empty string")
+{
+    CHECK(decode("").empty());
+}
+
+TEST_CASE("String without escapes is decoded as is")
+{
+    CHECK(decode("Hello.World") == "Hello.World");
+}
+
+TEST_CASE("Escaped characters are decoded")
+{
+    CHECK(decode("Music%2FSome%20Album%3A05") == "Music/Some Album:05");
+    CHECK(decode("%25") == "%");
+    CHECK(decode("%25%25") == "%%");
+    CHECK(decode("Caf%C3%A9") == "Caf\xc3\xa9");
+}
+
+TEST_CASE("Lower case hex digits are accepted")
+{
+    CHECK(decode("Caf%c3%a9%2f%2F") == "Caf\xc3\xa9//");
+}
+
+TEST_CASE("Decoding the encoded form of any byte gives the byte")
+{
+    for(unsigned int i = 0; i < 256; ++i)
+    {
+        const std::string src("x" + std::string(1, static_cast<char>(i)) + "y");
+        CHECK(decode(encode(src)) == src);
+    }
+}
+
+TEST_CASE("Invalid escape sequences are reported")
+{
+    DecodeError error;
+    CHECK(decode_with_error("abc%2Gdef", error) == "abc");
+    CHECK(error.code_ == StrBoUrl::ParseResult::Code::INVALID_ENCODING);
+    CHECK(error.offset_ == 3);
+
+    error = DecodeError();
+    CHECK(decode_with_error("%%20", error).empty());
+    CHECK(error.code_ == StrBoUrl::ParseResult::Code::INVALID_ENCODING);
+    CHECK(error.offset_ == 0);
+}
+
+TEST_CASE("Truncated escape sequences are reported")
+{
+    DecodeError error;
+    CHECK(decode_with_error("abc%2", error) == "abc");
+    CHECK(error.code_ == StrBoUrl::ParseResult::Code::TRUNCATED_ENCODING);
+    CHECK(error.offset_ == 3);
+
+    error = DecodeError();
+    CHECK(decode_with_error("%", error).empty());
+    CHECK(error.code_ == StrBoUrl::ParseResult::Code::TRUNCATED_ENCODING);
+    CHECK(error.offset_ == 0);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("URL structural index");
+
+TEST_CASE("Each byte value is validated like the set of valid characters")
+{
+    for(unsigned int i = 0; i < 256; ++i)
+    {
+        const bool is_valid =
+            i > 0 &&
+            StrBoUrl::Location::valid_characters.find(static_cast<char>(i)) != std::string::npos;
+
+        for(size_t pos = 0; pos < 40; ++pos)
+        {
+            std::string url(40, 'a');
+            url[pos] = static_cast<char>(i);
+
+            StrBoUrl::Parse::StructuralIndex index;
+            CHECK(index.scan(url, 0) == (is_valid ? StrBoUrl::Parse::StructuralIndex::npos : pos));
+        }
+    }
+}
+
+TEST_CASE("Scan starts at given offset")
+{
+    StrBoUrl::Parse::StructuralIndex index;
+    CHECK(index.scan("a b://c:d", 6) == StrBoUrl::Parse::StructuralIndex::npos);
+    CHECK(index.find(':', 0) == 7);
+    CHECK(index.find('/', 0) == StrBoUrl::Parse::StructuralIndex::npos);
+}
+
+TEST_CASE("Structural characters are found in range")
+{
+    const std::string url("x://ab:cd/e%20f:12345678901234567890:/");
+    StrBoUrl::Parse::StructuralIndex index;
+    REQUIRE(index.scan(url, 4) == StrBoUrl::Parse::StructuralIndex::npos);
+
+    CHECK(index.find(':', 4) == 6);
+    CHECK(index.find(':', 7) == 15);
+    CHECK(index.find('/', 4) == 9);
+    CHECK(index.find('%', 4) == 11);
+    CHECK(index.find(':', 16) == 36);
+    CHECK(index.find(':', 16, 36) == StrBoUrl::Parse::StructuralIndex::npos);
+    CHECK(index.find('/', 10) == 37);
+    CHECK(index.find('/', 38) == StrBoUrl::Parse::StructuralIndex::npos);
+}
+
+TEST_CASE("Index may contain many structural characters")
+{
+    std::string url;
+
+    for(size_t i = 0; i < 500; ++i)
+        url += "%20a:";
+
+    StrBoUrl::Parse::StructuralIndex index;
+    REQUIRE(index.scan(url, 0) == StrBoUrl::Parse::StructuralIndex::npos);
+
+    size_t count = 0;
+
+    for(size_t pos = index.find(':', 0);
+        pos != StrBoUrl::Parse::StructuralIndex::npos;
+        pos = index.find(':', pos + 1))
+    {
+        CHECK(url[pos] == ':');
+        ++count;
+    }
+
+    CHECK(count == 500);
+    CHECK(index.find('%', 1) == 5);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A StrBo-URL.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "strbo_url_usb_watcher.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <dirent.h>
+#include <ftw.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TEST_SUITE_BEGIN("USB location resolver");
+
+/*!
+ * Test fixture: temporary directory containing a mounted partition.
+ */
+class TreeFixture
+{
+  protected:
+    std::string root_;
+
+  public:
+    explicit TreeFixture()
+    {
+        char name[] = "/tmp/strbo_url_test.XXXXXX";
+        REQUIRE(mkdtemp(name) != nullptr);
+        root_ = name;
+
+        mkdir("dev");
+        mkdir("dev/part");
+        mkdir("dev/part/Music");
+        mkdir("dev/part/Music/Album A");
+        mkdir("dev/part/Music/Album B");
+        touch("dev/part/Music/Album A/01 - First.flac");
+        touch("dev/part/Music/Album A/02 - Second.flac");
+        touch("dev/part/Music/Album A/03 - Third.flac");
+        touch("dev/part/Music/Album B/01 - Other.flac");
+        touch("dev/part/readme.txt");
+    }
+
+    ~TreeFixture()
+    {
+        nftw(root_.c_str(),
+             [] (const char *path, const struct stat *, int, struct FTW *)
+             {
+                 return remove(path);
+             },
+             8, FTW_DEPTH | FTW_PHYS);
+    }
+
+  protected:
+    void mkdir(const std::string &path) const
+    {
+        REQUIRE(::mkdir((root_ + '/' + path).c_str(), 0755) == 0);
+    }
+
+    void touch(const std::string &path) const
+    {
+        FILE *f = fopen((root_ + '/' + path).c_str(), "w");
+        REQUIRE(f != nullptr);
+        fclose(f);
+    }
+};
+
+TEST_CASE_FIXTURE(TreeFixture, "Directory listings are sorted")
+{
+    USB::DirectoryListing listing;
+    REQUIRE(listing.read(root_ + "/dev/part/Music/Album A") == 0);
+    REQUIRE(listing.size() == 3);
+    CHECK(listing.get_name(StrBoUrl::ObjectIndex(1)) == "01 - First.flac");
+    CHECK(listing.get_name(StrBoUrl::ObjectIndex(3)) == "03 - Third.flac");
+    CHECK(listing.find("02 - Second.flac").get_object_index() == 2);
+    CHECK_FALSE(listing.find("04").is_valid());
+    CHECK(listing.is_at("03 - Third.flac", StrBoUrl::ObjectIndex(3)));
+    CHECK_FALSE(listing.is_at("03 - Third.flac", StrBoUrl::ObjectIndex(4)));
+    CHECK_FALSE(listing.is_at("03 - Third.flac", StrBoUrl::ObjectIndex()));
+
+    CHECK(listing.read(root_ + "/does/not/exist") == ENOENT);
+    CHECK(listing.empty());
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Reference key is resolved using its position hint")
+{
+    USB::Resolver resolver(root_);
+
+    USB::LocationKeyReference l;
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2FAlbum%20A/02%20-%20Second.flac:2").is_ok());
+
+    auto result(resolver.resolve(l));
+    CHECK(result.status_ == USB::Resolver::Status::OK);
+    CHECK(result.path_ == root_ + "/dev/part/Music/Album A/02 - Second.flac");
+    CHECK(result.position_.get_object_index() == 2);
+    CHECK(result.is_position_hint_correct_);
+
+    /* stale hint falls back to lookup by name */
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2FAlbum%20A/02%20-%20Second.flac:3").is_ok());
+    result = resolver.resolve(l);
+    CHECK(result.status_ == USB::Resolver::Status::OK);
+    CHECK(result.position_.get_object_index() == 2);
+    CHECK_FALSE(result.is_position_hint_correct_);
+    CHECK(resolver.get_number_of_cached_listings() == 1);
+
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2FAlbum%20A/04:4").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::NOT_FOUND);
+
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2FAlbum%20C/04:4").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::NOT_FOUND);
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Trace is resolved step by step")
+{
+    USB::Resolver resolver(root_);
+
+    USB::LocationTrace l;
+    REQUIRE(l.try_set_url("strbo-trace-usb://dev:part/Music/Album%20B%2F01%20-%20Other.flac:1").is_ok());
+
+    const auto result(resolver.resolve(l));
+    CHECK(result.status_ == USB::Resolver::Status::OK);
+    CHECK(result.path_ == root_ + "/dev/part/Music/Album B/01 - Other.flac");
+    CHECK(result.is_position_hint_correct_);
+    CHECK(resolver.get_number_of_cached_listings() == 2);
+
+    REQUIRE(l.try_set_url("strbo-trace-usb://dev:part//readme.txt:5").is_ok());
+    const auto root_item(resolver.resolve(l));
+    CHECK(root_item.status_ == USB::Resolver::Status::OK);
+    CHECK(root_item.path_ == root_ + "/dev/part/readme.txt");
+    CHECK(root_item.position_.get_object_index() == 2);
+
+    REQUIRE(l.try_set_url("strbo-trace-usb://dev:part/Music/readme.txt%2Fx:1").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::NOT_FOUND);
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Paths cannot leave the mount point")
+{
+    USB::Resolver resolver(root_);
+
+    USB::LocationKeyReference l;
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2F..%2F..%2F../dev:1").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::INVALID_LOCATION);
+
+    REQUIRE(l.try_set_url("strbo-ref-usb://..:part/Music/Album%20A:1").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::INVALID_LOCATION);
+
+    CHECK(resolver.resolve(USB::LocationKeyReference()).status_ ==
+          USB::Resolver::Status::INVALID_LOCATION);
+    CHECK(resolver.get_number_of_cached_listings() == 0);
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Least recently used listings are evicted")
+{
+    USB::Resolver resolver(root_, 2);
+    int error;
+
+    const std::string a(root_ + "/dev/part/Music/Album A");
+    const std::string b(root_ + "/dev/part/Music/Album B");
+    const std::string music(root_ + "/dev/part/Music");
+
+    REQUIRE(resolver.get_listing(a, error) != nullptr);
+    REQUIRE(resolver.get_listing(b, error) != nullptr);
+    REQUIRE(resolver.get_listing(a, error) != nullptr);
+    REQUIRE(resolver.get_listing(music, error) != nullptr);
+    CHECK(resolver.get_number_of_cached_listings() == 2);
+    CHECK_FALSE(resolver.forget(b));
+    CHECK(resolver.forget(a));
+    CHECK(resolver.get_number_of_cached_listings() == 1);
+
+    /* cached listings are used until they are forgotten */
+    touch("dev/part/Music/Album C");
+    CHECK(resolver.get_listing(music, error)->size() == 2);
+    resolver.clear_cache();
+    CHECK(resolver.get_listing(music, error)->size() == 3);
+
+    CHECK(resolver.get_listing(root_ + "/nothing", error) == nullptr);
+    CHECK(error == ENOENT);
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Persistent index is used across resolver instances")
+{
+    const std::string index_path(root_ + "/index");
+
+    USB::LocationTrace l;
+    REQUIRE(l.try_set_url("strbo-trace-usb://dev:part/Music/Album%20A%2F03%20-%20Third.flac:3").is_ok());
+
+    {
+        USB::Resolver resolver(root_);
+        CHECK(resolver.attach_index(index_path) == ENOENT);
+        CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::OK);
+        CHECK(resolver.get_number_of_index_hits() == 0);
+        CHECK(resolver.get_number_of_pending_index_updates() == 2);
+        REQUIRE(resolver.save_index() == 0);
+        CHECK(resolver.get_number_of_pending_index_updates() == 0);
+    }
+
+    {
+        USB::Resolver resolver(root_);
+        REQUIRE(resolver.attach_index(index_path) == 0);
+
+        const auto result(resolver.resolve(l));
+        CHECK(result.status_ == USB::Resolver::Status::OK);
+        CHECK(result.path_ == root_ + "/dev/part/Music/Album A/03 - Third.flac");
+        CHECK(result.is_position_hint_correct_);
+        CHECK(resolver.get_number_of_index_hits() == 2);
+        CHECK(resolver.get_number_of_cached_listings() == 0);
+        CHECK(resolver.get_number_of_pending_index_updates() == 0);
+    }
+
+    /* only the modified directory is read again */
+    touch("dev/part/Music/Album A/00 - Intro.flac");
+
+    {
+        USB::Resolver resolver(root_);
+        REQUIRE(resolver.attach_index(index_path) == 0);
+
+        const auto result(resolver.resolve(l));
+        CHECK(result.status_ == USB::Resolver::Status::OK);
+        CHECK(result.position_.get_object_index() == 4);
+        CHECK_FALSE(result.is_position_hint_correct_);
+        CHECK(resolver.get_number_of_index_hits() == 1);
+        CHECK(resolver.get_number_of_pending_index_updates() == 1);
+
+        REQUIRE(resolver.save_index() == 0);
+    }
+
+    {
+        USB::Resolver resolver(root_);
+        REQUIRE(resolver.attach_index(index_path) == 0);
+        CHECK(resolver.resolve(l).position_.get_object_index() == 4);
+        CHECK(resolver.get_number_of_index_hits() == 2);
+    }
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Saving the index does not touch other writers' files")
+{
+    const std::string index_path(root_ + "/index");
+
+    /* stands in for the temporary file of a concurrent writer */
+    FILE *f = fopen((index_path + ".tmp").c_str(), "w");
+    REQUIRE(f != nullptr);
+    fputs("in progress", f);
+    fclose(f);
+
+    USB::LocationKeyReference l;
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2FAlbum%20A/02%20-%20Second.flac:2").is_ok());
+
+    USB::Resolver resolver(root_);
+    CHECK(resolver.attach_index(index_path) == ENOENT);
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::OK);
+    REQUIRE(resolver.save_index() == 0);
+
+    struct stat st;
+    REQUIRE(stat((index_path + ".tmp").c_str(), &st) == 0);
+    CHECK(st.st_size == 11);
+    REQUIRE(stat(index_path.c_str(), &st) == 0);
+    CHECK((st.st_mode & 0777) == 0644);
+
+    /* no temporary file of our own is left behind */
+    std::vector<std::string> names;
+    DIR *dir = opendir(root_.c_str());
+    REQUIRE(dir != nullptr);
+
+    for(const struct dirent *de = readdir(dir); de != nullptr; de = readdir(dir))
+        if(de->d_name[0] != '.')
+            names.emplace_back(de->d_name);
+
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    CHECK(names == std::vector<std::string>({"dev", "index", "index.tmp"}));
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Invalid index files are ignored")
+{
+    const std::string index_path(root_ + "/index");
+
+    FILE *f = fopen(index_path.c_str(), "w");
+    REQUIRE(f != nullptr);
+    fputs("This is not an index file, but it is long enough to have a header", f);
+    fclose(f);
+
+    USB::Resolver resolver(root_);
+    CHECK(resolver.attach_index(index_path) == EINVAL);
+
+    USB::LocationKeyReference l;
+    REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music/Album%20B:2").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::OK);
+    CHECK(resolver.save_index() == 0);
+    CHECK(resolver.attach_index(index_path) == 0);
+}
+
+static bool wait_for_events(const USB::DirectoryWatcher &watcher)
+{
+    struct pollfd pfd {watcher.get_fd(), POLLIN, 0};
+    return poll(&pfd, 1, 1000) == 1;
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Cache event handler is called before directory is read")
+{
+    USB::Resolver resolver(root_);
+    std::vector<std::pair<std::string, bool>> events;
+
+    /* changes made by the handler stand in for changes made between adding
+     * a watch and reading the directory */
+    resolver.set_cache_event_handler(
+        [this, &events] (const std::string &path, bool is_added)
+        {
+            events.emplace_back(path, is_added);
+
+            if(is_added && path == root_ + "/dev/part/Music/Album B")
+                touch("dev/part/Music/Album B/02 - Added.flac");
+            else if(is_added && path == root_ + "/dev/part/Music/Album C")
+                REQUIRE(rmdir(path.c_str()) == 0);
+
+            return true;
+        });
+
+    int error;
+    const auto *l = resolver.get_listing(root_ + "/dev/part/Music/Album B", error);
+    REQUIRE(l != nullptr);
+    CHECK(l->size() == 2);
+    CHECK(l->find("02 - Added.flac").get_object_index() == 2);
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].second);
+
+    /* directory removed after handler call, handler is told to drop it */
+    mkdir("dev/part/Music/Album C");
+    events.clear();
+    CHECK(resolver.get_listing(root_ + "/dev/part/Music/Album C", error) == nullptr);
+    CHECK(error == ENOENT);
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].second);
+    CHECK(events[1].first == root_ + "/dev/part/Music/Album C");
+    CHECK_FALSE(events[1].second);
+    CHECK(resolver.get_number_of_cached_listings() == 1);
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Changed directories are evicted from the cache")
+{
+    USB::Resolver resolver(root_);
+    USB::DirectoryWatcher watcher(resolver);
+    REQUIRE(watcher.open() == 0);
+    CHECK(watcher.process_events() == 0);
+
+    USB::LocationTrace l;
+    REQUIRE(l.try_set_url("strbo-trace-usb://dev:part/Music/Album%20A%2F03%20-%20Third.flac:3").is_ok());
+    CHECK(resolver.resolve(l).is_position_hint_correct_);
+    CHECK(resolver.get_number_of_cached_listings() == 2);
+    CHECK(watcher.get_number_of_watches() == 2);
+
+    touch("dev/part/Music/Album A/00 - Intro.flac");
+    REQUIRE(wait_for_events(watcher));
+    CHECK(watcher.process_events() == 1);
+    CHECK(resolver.get_number_of_cached_listings() == 1);
+    CHECK(watcher.get_number_of_watches() == 1);
+
+    const auto result(resolver.resolve(l));
+    CHECK(result.position_.get_object_index() == 4);
+    CHECK_FALSE(result.is_position_hint_correct_);
+    CHECK(watcher.get_number_of_watches() == 2);
+
+    /* renaming a directory evicts its parent and everything below */
+    REQUIRE(rename((root_ + "/dev/part/Music/Album A").c_str(),
+                   (root_ + "/dev/part/Music/Album X").c_str()) == 0);
+    REQUIRE(wait_for_events(watcher));
+    CHECK(watcher.process_events() == 2);
+    CHECK(resolver.get_number_of_cached_listings() == 0);
+    CHECK(watcher.get_number_of_watches() == 0);
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::NOT_FOUND);
+
+    watcher.close();
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::NOT_FOUND);
+    CHECK(resolver.get_number_of_cached_listings() == 1);
+}
+
+TEST_CASE_FIXTURE(TreeFixture, "Number of watches is limited")
+{
+    USB::Resolver resolver(root_);
+    USB::DirectoryWatcher watcher(resolver, 1);
+    REQUIRE(watcher.open() == 0);
+
+    USB::LocationTrace l;
+    REQUIRE(l.try_set_url("strbo-trace-usb://dev:part/Music/Album%20B%2F01%20-%20Other.flac:1").is_ok());
+    CHECK(resolver.resolve(l).status_ == USB::Resolver::Status::OK);
+    CHECK(resolver.get_number_of_cached_listings() == 1);
+    CHECK(watcher.get_number_of_watches() == 1);
+
+    /* unwatched directories are not cached, so changes are seen anyway */
+    touch("dev/part/Music/Album B/00 - Intro.flac");
+    const auto result(resolver.resolve(l));
+    CHECK(result.status_ == USB::Resolver::Status::OK);
+    CHECK(result.position_.get_object_index() == 2);
+}
+
+TEST_SUITE_END();
@@ -27,6 +27,9 @@
 
 #include "strbo_url_usb.hh"
 
+#include <thread>
+#include <vector>
+
 TEST_SUITE_BEGIN("StrBo USB URLs");
 
 class SimpleLocatorFixture
@@ -57,6 +60,102 @@ TEST_CASE_FIXTURE(SimpleLocatorFixture, "Set locator from URL with wrong scheme
     CHECK(url.str().empty());
 }
 
+TEST_CASE_FIXTURE(SimpleLocatorFixture, "Trying to set locator reports errors without throwing")
+{
+    const auto wrong_scheme(url.try_set_url("strbo-us://not_parsed"));
+    CHECK(wrong_scheme.get_code() == StrBoUrl::ParseResult::Code::WRONG_SCHEME);
+    CHECK(wrong_scheme.get_offset() == 0);
+
+    const auto bad_encoding(url.try_set_url("strbo-usb://dev:part/a%2Gb"));
+    CHECK(bad_encoding.get_code() == StrBoUrl::ParseResult::Code::INVALID_ENCODING);
+    CHECK(bad_encoding.get_component() == StrBoUrl::ParseResult::Component::ITEM_NAME);
+    CHECK(bad_encoding.get_offset() == 22);
+
+    CHECK(url.str().empty());
+
+    const auto ok(url.try_set_url("strbo-usb://dev:part/a%2Fb"));
+    CHECK(ok.is_ok());
+    CHECK(ok.get_warning() == nullptr);
+    CHECK(url.unpack().path_ == "a/b");
+}
+
+TEST_CASE("Set reference locator from view into larger buffer")
+{
+    const char buffer[] = "strbo-ref-usb://dev:part/Music/Song.flac:5123 trailing data";
+    const std::string_view view(buffer, 42);
+
+    USB::LocationKeyReference url;
+    CHECK(url.set_url(view) == nullptr);
+    REQUIRE(url.is_valid());
+    CHECK(url.str() == view);
+
+    const auto &c(url.unpack());
+    CHECK(c.reference_point_ == "Music");
+    CHECK(c.item_name_ == "Song.flac");
+    CHECK(c.item_position_.get_object_index() == 5);
+}
+
+TEST_CASE("Item positions are parsed strictly")
+{
+    USB::LocationKeyReference url;
+
+    const auto junk(url.try_set_url("strbo-ref-usb://dev:part/ref/item:5x"));
+    CHECK(junk.get_code() == StrBoUrl::ParseResult::Code::TRAILING_JUNK);
+    CHECK(junk.get_component() == StrBoUrl::ParseResult::Component::ITEM_POSITION);
+    CHECK(junk.get_offset() == 35);
+
+    CHECK(url.try_set_url("strbo-ref-usb://dev:part/ref/item:+5").get_code() ==
+          StrBoUrl::ParseResult::Code::TRAILING_JUNK);
+    CHECK(url.try_set_url("strbo-ref-usb://dev:part/ref/item:").get_code() ==
+          StrBoUrl::ParseResult::Code::COMPONENT_EMPTY);
+    CHECK(url.try_set_url("strbo-ref-usb://dev:part/ref/item:4294967296").get_code() ==
+          StrBoUrl::ParseResult::Code::OUT_OF_RANGE);
+
+    CHECK(url.try_set_url("strbo-ref-usb://dev:part/ref/item:4294967295").is_ok());
+    CHECK(url.unpack().item_position_.get_object_index() == 4294967295U);
+}
+
+TEST_CASE("Object index is parsed from exact range and formatted")
+{
+    const char digits[] = "12345";
+    StrBoUrl::ObjectIndex idx;
+    const char *where;
+
+    CHECK(StrBoUrl::ObjectIndex::from_chars(digits, digits + 3, idx, where) ==
+          StrBoUrl::ParseResult::Code::OK);
+    CHECK(idx.get_object_index() == 123);
+
+    char buffer[StrBoUrl::ObjectIndex::MAX_CHARS];
+    const char *end = StrBoUrl::ObjectIndex(4294967295U).to_chars(buffer, buffer + sizeof(buffer));
+    REQUIRE(end != nullptr);
+    CHECK(std::string(buffer, end - buffer) == "4294967295");
+    CHECK(idx.to_chars(buffer, buffer + 2) == nullptr);
+}
+
+TEST_CASE_FIXTURE(SimpleLocatorFixture, "Parsing error is formatted into caller buffer")
+{
+    try
+    {
+        url.set_url("strbo-usb://dev:part/a%2Gb");
+        FAIL("Expected exception");
+    }
+    catch(const StrBoUrl::Location::ParsingError &e)
+    {
+        CHECK(e.get_result().get_code() == StrBoUrl::ParseResult::Code::INVALID_ENCODING);
+        CHECK(std::string(e.what()) == "Invalid URL-encoding");
+
+        const std::string expected("Simple USB location key malformed: "
+                                   "Invalid URL-encoding [Item name] at offset 22");
+        char buffer[128];
+        CHECK(e.format(buffer, sizeof(buffer)) == expected.length());
+        CHECK(std::string(buffer) == expected);
+
+        char small[8];
+        CHECK(e.format(small, sizeof(small)) == expected.length());
+        CHECK(std::string(small) == expected.substr(0, sizeof(small) - 1));
+    }
+}
+
 TEST_CASE_FIXTURE(SimpleLocatorFixture, "Set locator for file from valid USB URL string")
 {
     const std::string expected("strbo-usb://usb-Generic_Flash_Disk_1EB86759-0%3A0:usb-Generic_Flash_Disk_1EB86759-0%3A0-part1/Music%2FSome%20Album%2F05%20-%20Song.flac");
@@ -110,12 +209,201 @@ TEST_CASE_FIXTURE(SimpleLocatorFixture, "Set locator for file by appending")
     CHECK(url.str() == expected);
 }
 
+TEST_CASE_FIXTURE(SimpleLocatorFixture, "Serialize locator into caller-provided buffers")
+{
+    const std::string expected("strbo-usb://My%20Device:part1/Some%20File.flac");
+    CHECK(url.encoded_length() == 0);
+
+    url.set_device("My Device");
+    url.set_partition("part1");
+    url.set_path("Some File.flac");
+    REQUIRE(url.is_valid());
+    CHECK(url.encoded_length() == expected.length());
+
+    std::string buffer("previous contents which are longer than the URL");
+    url.str_into(buffer);
+    CHECK(buffer == expected);
+
+    char raw[64];
+    CHECK(url.write_to(raw, sizeof(raw)) == expected.length());
+    CHECK(std::string(raw, expected.length()) == expected);
+
+    char too_small[8] = "unused";
+    CHECK(url.write_to(too_small, sizeof(too_small)) == expected.length());
+    CHECK(std::string(too_small) == "unused");
+}
+
+TEST_CASE("Device and partition names are shared between locations")
+{
+    const size_t pool_size = StrBoUrl::InternedString::get_pool_size();
+
+    {
+        USB::LocationKeySimple a;
+        USB::LocationKeyReference b;
+        USB::LocationTrace c;
+        CHECK(a.set_url("strbo-usb://My%20Stick:usb-0%3A0-part1/a") == nullptr);
+        CHECK(b.set_url("strbo-ref-usb://My%20Stick:usb-0%3a0-part1/ref/b:1") == nullptr);
+        CHECK(c.set_url("strbo-trace-usb://My%20Stick:usb-0%3A0-part1/ref/c:1") == nullptr);
+
+        CHECK(a.unpack().device_ == "My Stick");
+        CHECK(a.unpack().device_ == b.unpack().device_);
+        CHECK(a.unpack().partition_ == b.unpack().partition_);
+        CHECK(a.unpack().partition_ == c.unpack().partition_);
+        CHECK(a.unpack().partition_.get_encoded() == "usb-0%3A0-part1");
+        CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size + 2);
+
+        /* canonical encoding is used for serialization */
+        CHECK(b.str() == "strbo-ref-usb://My%20Stick:usb-0%3A0-part1/ref/b:1");
+
+        b.set_device("Other Stick");
+        CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size + 3);
+        CHECK(b.str() == "strbo-ref-usb://Other%20Stick:usb-0%3A0-part1/ref/b:1");
+    }
+
+    CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size);
+}
+
+TEST_CASE("Interning invalid encodings yields empty strings")
+{
+    const size_t pool_size = StrBoUrl::InternedString::get_pool_size();
+
+    CHECK(StrBoUrl::InternedString::from_encoded("%zz").empty());
+    CHECK(StrBoUrl::InternedString::from_encoded("%2").empty());
+    CHECK(StrBoUrl::InternedString::from_encoded("Stick%g0").empty());
+    CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size);
+
+    const auto s(StrBoUrl::InternedString::from_encoded("My%20Stick"));
+    CHECK(s == "My Stick");
+}
+
+TEST_CASE("Device and partition names are interned by concurrent threads")
+{
+    const size_t pool_size = StrBoUrl::InternedString::get_pool_size();
+
+    std::vector<std::thread> threads;
+
+    for(unsigned int t = 0; t < 4; ++t)
+        threads.emplace_back(
+            [t] ()
+            {
+                USB::LocationKeySimple a;
+                USB::LocationKeySimple b;
+
+                for(unsigned int i = 0; i < 2000; ++i)
+                {
+                    /* one shared device, and a device per thread which comes
+                     * and goes with each iteration */
+                    a.set_url("strbo-usb://Shared%20Stick:part1/a");
+                    b.set_url("strbo-usb://Stick" + std::to_string(t) + ":part" +
+                              std::to_string(i % 3) + "/b");
+                    a.clear();
+                    b.clear();
+                }
+            });
+
+    for(auto &t : threads)
+        t.join();
+
+    CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size);
+
+    /* strings are interned again after all handles were gone */
+    for(int i = 0; i < 2; ++i)
+    {
+        USB::LocationKeySimple a;
+        CHECK(a.set_url("strbo-usb://Shared%20Stick:part1/a") == nullptr);
+        CHECK(a.unpack().device_ == "Shared Stick");
+        CHECK(a.unpack().device_.get_encoded() == "Shared%20Stick");
+        CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size + 2);
+    }
+
+    CHECK(StrBoUrl::InternedString::get_pool_size() == pool_size);
+}
+
+TEST_CASE("Locators are copyable and movable")
+{
+    USB::LocationKeyReference url;
+    CHECK(url.set_url("strbo-ref-usb://dev:part/ref/item:2") == nullptr);
+
+    USB::LocationKeyReference copy(url);
+    CHECK(copy.str() == url.str());
+    CHECK(&copy.get_scheme() == &url.get_scheme());
+
+    USB::LocationKeyReference moved(std::move(copy));
+    CHECK(moved.str() == "strbo-ref-usb://dev:part/ref/item:2");
+
+    copy = moved;
+    moved.clear();
+    CHECK_FALSE(moved.is_valid());
+    CHECK(copy.is_valid());
+    CHECK(copy.unpack().item_name_ == "item");
+}
+
 TEST_CASE_FIXTURE(SimpleLocatorFixture, "Clear locator")
 {
     CHECK(url.set_url("strbo-usb://dev:part/file") == nullptr);
     REQUIRE(url.is_valid());
+    CHECK(url.str() == "strbo-usb://dev:part/file");
     url.clear();
     CHECK_FALSE(url.is_valid());
+    CHECK(url.str().empty());
+}
+
+TEST_CASE_FIXTURE(SimpleLocatorFixture, "URL representation is kept until locator is modified")
+{
+    CHECK(url.set_url("strbo-usb://dev:part/file") == nullptr);
+
+    const std::string &first(url.str());
+    CHECK(first == "strbo-usb://dev:part/file");
+    CHECK(&url.str() == &first);
+    CHECK(url.encoded_length() == first.length());
+
+    url.append_to_path("more");
+    CHECK(url.str() == "strbo-usb://dev:part/file%2Fmore");
+    url.set_device("other");
+    CHECK(url.str() == "strbo-usb://other:part/file%2Fmore");
+
+    CHECK(url.try_set_url("strbo-usb://dev:part/x").is_ok());
+    CHECK(url.str() == "strbo-usb://dev:part/x");
+    CHECK(url.try_set_url("strbo-ref-usb://dev:part/ref/item:2").get_code() ==
+          StrBoUrl::ParseResult::Code::WRONG_SCHEME);
+    CHECK(url.str() == "strbo-usb://dev:part/x");
+
+    USB::LocationKeySimple other;
+    other = url;
+    CHECK(other.str() == "strbo-usb://dev:part/x");
+    other.set_path("y");
+    CHECK(other.str() == "strbo-usb://dev:part/y");
+    CHECK(url.str() == "strbo-usb://dev:part/x");
+
+    const std::string *kept = &other.str();
+    url = std::move(other);
+    CHECK(&url.str() == kept);
+    CHECK(url.str() == "strbo-usb://dev:part/y");
+}
+
+TEST_CASE("URL representation is generated once for concurrent threads")
+{
+    for(int round = 0; round < 50; ++round)
+    {
+        USB::LocationKeyReference l;
+        REQUIRE(l.try_set_url("strbo-ref-usb://dev:part/Music%2FSome%20Album/05%20-%20Song.flac:5").is_ok());
+
+        const USB::LocationKeyReference &cl(l);
+        const std::string *results[4];
+        std::vector<std::thread> threads;
+
+        for(auto &r : results)
+            threads.emplace_back([&cl, &r] () { r = &cl.str(); });
+
+        for(auto &t : threads)
+            t.join();
+
+        for(const auto *r : results)
+        {
+            CHECK(r == &cl.str());
+            CHECK(*r == "strbo-ref-usb://dev:part/Music%2FSome%20Album/05%20-%20Song.flac:5");
+        }
+    }
 }
 
 TEST_SUITE_END();